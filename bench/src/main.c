@@ -0,0 +1,383 @@
+/**
+ * Fixed function cost matrix.
+ *
+ * Sweeps the state the samples use (lights, texture size and filter,
+ * blending, wireframe line width, shade model, depth bits) over two
+ * standard workloads and prints one row per combination:
+ *
+ *  - fill: FILL_LAYERS full screen layers of a coarse lit grid, Mpixels/s
+ *    is the covered area divided by the time. Wireframe rows only touch
+ *    the grid edges, so they print - here and compare on Mtris/s alone.
+ *  - geometry: a GEOM_GRID x GEOM_GRID grid squeezed into a GEOM_SIZE
+ *    viewport, so the cost is per vertex and per triangle, Mtris/s.
+ *
+ * Rows come out in a fixed order so the table, also written to
+ * RESULTS_PATH, can be diffed between builds.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/osmesa.h>
+
+#include <psp2/power.h>
+#include <psp2/kernel/threadmgr.h>
+#include <psp2/kernel/processmgr.h>
+#include <psp2shell.h>
+
+#include "checker.h"
+
+#define printf psp2shell_print
+
+#define WIDTH 960
+#define HEIGHT 544
+
+#define RESULTS_PATH "ux0:data/osmesa_bench.txt"
+
+#define FILL_GRID 8
+#define FILL_LAYERS 4
+#define GEOM_GRID 64
+#define GEOM_SIZE 64
+
+/* time spent on each cell and workload, in microseconds */
+#define MIN_TIME 100000
+
+/* the matrix, edit to taste */
+static const int light_counts[] = {0, 1, 4, 8};
+static const int depth_bits[] = {0, 16, 24};
+static const int blends[] = {0, 1};
+static const GLenum shade_models[] = {GL_FLAT, GL_SMOOTH};
+static const GLfloat line_widths[] = {0.0, 1.0, 2.0};     /* 0 is filled polygons */
+
+static const struct {
+    const char *name;
+    int size;
+    GLenum filter;
+} textures[] = {
+        {"off",       0,   0},
+        {"64/near",   64,  GL_NEAREST},
+        {"64/lin",    64,  GL_LINEAR},
+        {"256/near",  256, GL_NEAREST},
+        {"256/lin",   256, GL_LINEAR},
+        {"256/mip",   256, GL_LINEAR_MIPMAP_LINEAR},
+};
+
+#define COUNT(a) ((int) (sizeof(a) / sizeof((a)[0])))
+
+struct mesh {
+    GLfloat *vertices;          /* x y z nx ny nz s t */
+    GLushort *indices;
+    int num_indices;
+};
+
+static GLubyte *buffer = NULL;
+static struct mesh fill_mesh, geom_mesh;
+static GLuint texture_names[COUNT(textures)];
+static FILE *results = NULL;
+
+/* a grid over [-1, 1] facing +Z, as two triangles per cell */
+static void make_grid(struct mesh *m, int n) {
+    int i, j, k = 0;
+
+    m->vertices = malloc((n + 1) * (n + 1) * 8 * sizeof(GLfloat));
+    m->indices = malloc(n * n * 6 * sizeof(GLushort));
+    m->num_indices = n * n * 6;
+
+    for (i = 0; i <= n; i++) {
+        for (j = 0; j <= n; j++) {
+            GLfloat *v = &m->vertices[(i * (n + 1) + j) * 8];
+            v[0] = -1.0 + 2.0 * j / n;
+            v[1] = -1.0 + 2.0 * i / n;
+            v[2] = 0.0;
+            v[3] = 0.0;
+            v[4] = 0.0;
+            v[5] = 1.0;
+            v[6] = (GLfloat) j / n;
+            v[7] = (GLfloat) i / n;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            GLushort a = i * (n + 1) + j, b = a + 1, c = a + n + 1, d = c + 1;
+            m->indices[k++] = a;
+            m->indices[k++] = b;
+            m->indices[k++] = d;
+            m->indices[k++] = a;
+            m->indices[k++] = d;
+            m->indices[k++] = c;
+        }
+    }
+}
+
+static void make_textures(void) {
+    int t;
+
+    glGenTextures(COUNT(textures), texture_names);
+    for (t = 0; t < COUNT(textures); t++) {
+        int size = textures[t].size;
+        GLubyte *image;
+
+        if (!size) {
+            continue;
+        }
+        image = malloc(size * size * 4);
+        Checker(image, size, size);
+
+        glBindTexture(GL_TEXTURE_2D, texture_names[t]);
+        if (textures[t].filter == GL_LINEAR_MIPMAP_LINEAR) {
+            glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textures[t].filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                        textures[t].filter == GL_NEAREST ? GL_NEAREST : GL_LINEAR);
+        free(image);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void setup_state(int lights, int texture, int blend, GLfloat line_width,
+                        GLenum shade_model, int depth) {
+    static const GLfloat mat[4] = {0.8, 0.4, 0.8, 0.6};
+    int i;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(-1, 1, -1, 1, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    for (i = 0; i < 8; i++) {
+        if (i < lights) {
+            GLfloat pos[4] = {(GLfloat) (i % 3) - 1.0f, (GLfloat) (i / 3) - 1.0f, 1.0, 0.0};
+            /* GL_LIGHT1..7 default to a black diffuse, give each a share of white */
+            GLfloat diffuse[4] = {1.0f / lights, 1.0f / lights, 1.0f / lights, 1.0};
+            glLightfv(GL_LIGHT0 + i, GL_POSITION, pos);
+            glLightfv(GL_LIGHT0 + i, GL_DIFFUSE, diffuse);
+            glEnable(GL_LIGHT0 + i);
+        } else {
+            glDisable(GL_LIGHT0 + i);
+        }
+    }
+    if (lights) {
+        glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, mat);
+        glEnable(GL_LIGHTING);
+    } else {
+        glColor4fv(mat);
+        glDisable(GL_LIGHTING);
+    }
+
+    if (textures[texture].size) {
+        glBindTexture(GL_TEXTURE_2D, texture_names[texture]);
+        glEnable(GL_TEXTURE_2D);
+    } else {
+        glDisable(GL_TEXTURE_2D);
+    }
+
+    if (blend) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+
+    if (line_width > 0.0) {
+        glLineWidth(line_width);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    } else {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+
+    glShadeModel(shade_model);
+
+    if (depth) {
+        /* every layer sits at the same depth and passes */
+        glDepthFunc(GL_LEQUAL);
+        glEnable(GL_DEPTH_TEST);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+}
+
+static void draw_mesh(const struct mesh *m) {
+    glVertexPointer(3, GL_FLOAT, 8 * sizeof(GLfloat), m->vertices);
+    glNormalPointer(GL_FLOAT, 8 * sizeof(GLfloat), m->vertices + 3);
+    glTexCoordPointer(2, GL_FLOAT, 8 * sizeof(GLfloat), m->vertices + 6);
+    glDrawElements(GL_TRIANGLES, m->num_indices, GL_UNSIGNED_SHORT, m->indices);
+}
+
+/* microseconds per clear of the current scissor box */
+static double clear_time(void) {
+    uint64_t t0, t;
+    int passes = 0;
+
+    t0 = sceKernelGetProcessTimeWide();
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glFinish();
+        passes++;
+        t = sceKernelGetProcessTimeWide();
+    } while (t - t0 < MIN_TIME / 4);
+
+    return (double) (t - t0) / passes;
+}
+
+/**
+ * Repeat a workload until MIN_TIME, returns units per second. The clear
+ * before each pass is limited to the workload viewport and its time is
+ * taken out, so only the draws are measured.
+ */
+static double measure(const struct mesh *m, int layers, int w, int h, double units_per_pass) {
+    uint64_t t0, t;
+    double clear, elapsed;
+    int passes = 0, i;
+
+    glViewport(0, 0, w, h);
+    glScissor(0, 0, w, h);
+    glEnable(GL_SCISSOR_TEST);
+
+    /* warm up, the first draw validates state and uploads textures */
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    draw_mesh(m);
+    glFinish();
+    clear = clear_time();
+
+    t0 = sceKernelGetProcessTimeWide();
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (i = 0; i < layers; i++) {
+            draw_mesh(m);
+        }
+        glFinish();
+        passes++;
+        t = sceKernelGetProcessTimeWide();
+    } while (t - t0 < MIN_TIME);
+
+    glDisable(GL_SCISSOR_TEST);
+
+    elapsed = (t - t0) - passes * clear;
+    if (elapsed <= 0.0) {
+        return 0.0;
+    }
+    return units_per_pass * passes / (elapsed / 1000000.0);
+}
+
+static void output(const char *line) {
+    printf("%s", line);
+    if (results) {
+        fputs(line, results);
+    }
+}
+
+static int run_depth(int depth) {
+    const GLint stencil = 0, accum = 0;
+    OSMesaContext ctx;
+    char line[256];
+    int l, t, b, lw, s;
+
+    ctx = OSMesaCreateContextExt(OSMESA_RGBA, depth, stencil, accum, NULL);
+    if (!ctx) {
+        printf("OSMesaCreateContextExt() failed!\n");
+        return 0;
+    }
+    if (!OSMesaMakeCurrent(ctx, buffer, GL_UNSIGNED_BYTE, WIDTH, HEIGHT)) {
+        printf("OSMesaMakeCurrent (8 bits/channel) failed!\n");
+        OSMesaDestroyContext(ctx);
+        return 0;
+    }
+    OSMesaColorClamp(GL_TRUE);
+
+    snprintf(line, sizeof(line), "# %s, %s, %d depth bits\n",
+             (char *) glGetString(GL_RENDERER), (char *) glGetString(GL_VERSION), depth);
+    output(line);
+
+    make_textures();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClearColor(0.3, 0.3, 0.7, 0.0);
+
+    for (l = 0; l < COUNT(light_counts); l++) {
+        for (t = 0; t < COUNT(textures); t++) {
+            for (b = 0; b < COUNT(blends); b++) {
+                for (lw = 0; lw < COUNT(line_widths); lw++) {
+                    for (s = 0; s < COUNT(shade_models); s++) {
+                        char width[16], mpix[16];
+                        double mtris;
+
+                        setup_state(light_counts[l], t, blends[b], line_widths[lw],
+                                    shade_models[s], depth);
+                        mtris = measure(&geom_mesh, 1, GEOM_SIZE, GEOM_SIZE,
+                                        geom_mesh.num_indices / 3) / 1e6;
+
+                        if (line_widths[lw] > 0.0) {
+                            /* the covered area of a wireframe is not the screen */
+                            snprintf(width, sizeof(width), "%g", line_widths[lw]);
+                            strcpy(mpix, "-");
+                        } else {
+                            strcpy(width, "fill");
+                            snprintf(mpix, sizeof(mpix), "%.2f",
+                                     measure(&fill_mesh, FILL_LAYERS, WIDTH, HEIGHT,
+                                             (double) WIDTH * HEIGHT * FILL_LAYERS) / 1e6);
+                        }
+                        snprintf(line, sizeof(line), "%8d %-9s %5s %4s %6s %5d %8s %9.3f\n",
+                                 light_counts[l], textures[t].name, blends[b] ? "on" : "off", width,
+                                 shade_models[s] == GL_FLAT ? "flat" : "smooth", depth, mpix, mtris);
+                        output(line);
+                    }
+                }
+            }
+        }
+    }
+
+    glDeleteTextures(COUNT(textures), texture_names);
+    OSMesaDestroyContext(ctx);
+
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    char line[256];
+    int d;
+
+    psp2shell_init(3333, 5);
+    printf("Hello, (GL)world!\n");
+
+    // same clocks as gears
+    scePowerSetArmClockFrequency(444);
+    scePowerSetBusClockFrequency(222);
+    scePowerSetGpuClockFrequency(222);
+    scePowerSetGpuXbarClockFrequency(166);
+
+    buffer = malloc(WIDTH * HEIGHT * 4);
+    make_grid(&fill_mesh, FILL_GRID);
+    make_grid(&geom_mesh, GEOM_GRID);
+
+    results = fopen(RESULTS_PATH, "w");
+    if (!results) {
+        printf("can't write %s, printing only\n", RESULTS_PATH);
+    }
+
+    snprintf(line, sizeof(line), "# fill %dx%d x%d layers, geometry %d tris in %dx%d\n",
+             WIDTH, HEIGHT, FILL_LAYERS, geom_mesh.num_indices / 3, GEOM_SIZE, GEOM_SIZE);
+    output(line);
+    output("#  lights texture   blend line  shade depth   Mpix/s   Mtris/s\n");
+
+    for (d = 0; d < COUNT(depth_bits); d++) {
+        if (!run_depth(depth_bits[d])) {
+            break;
+        }
+    }
+
+    if (results) {
+        fclose(results);
+    }
+    printf("done\n");
+
+    sceKernelDelayThread(100 * 1000000);
+
+    psp2shell_exit();
+    sceKernelExitProcess(0);
+    return 0;
+}
@@ -0,0 +1,485 @@
+/**
+ * farm - render turntable sequences of the sample scenes offline, on all
+ * cores of a Linux box.
+ *
+ *   farm [-j workers] [-s] [-n frames] [-r WxH] [-o dir] [-f file] [scene ...]
+ *
+ * ostest1 is drawn from a scene file built by tools/scenec, by default the
+ * one built from ostest1/scene/ostest1.txt next to the farm; -f picks
+ * another.
+ *
+ * Each worker thread owns an OSMesa context and preallocated buffers. Jobs
+ * (scene, angle, resolution) are dealt round robin into per worker queues;
+ * a worker pops from the back of its own queue and steals from the front
+ * of the others when it runs dry. Finished buffers are handed to a writer
+ * thread, which writes them as PPM when -o is given, so workers never wait
+ * on file I/O. With -s the run is repeated for 1..workers threads.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <GL/osmesa.h>
+
+#include "scenes.h"
+
+#define BUFFERS_PER_WORKER 2
+
+#ifndef OSTEST1_SCENE
+#define OSTEST1_SCENE "ostest1.scn"
+#endif
+
+struct job {
+    int scene;
+    int index;
+    float angle;
+    int width, height;
+};
+
+/* per worker job queue, the owner takes from the tail, thieves from the head */
+struct deque {
+    pthread_mutex_t lock;
+    struct job *jobs;
+    int head, tail;
+};
+
+struct frame {
+    struct job job;
+    GLubyte *pixels;
+    struct frame *next;
+};
+
+struct worker {
+    pthread_t thread;
+    int id;
+    struct deque queue;
+    struct farm *farm;
+    struct frame *frame;        /* buffer being rendered to */
+    int frames;
+    int steals;
+    double busy;                /* seconds rendering */
+    double idle;                /* seconds looking for work or waiting for others */
+    double started, finished;
+};
+
+struct farm {
+    struct worker *workers;
+    int num_workers;
+    const char *outdir;
+    size_t frame_size;
+    pthread_barrier_t start;
+
+    /* finished frames for the writer, and buffers free for reuse */
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    struct frame *written_head, **written_tail;
+    struct frame *free_frames;
+    int workers_left;
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static struct frame *frame_get(struct farm *farm) {
+    struct frame *f;
+
+    pthread_mutex_lock(&farm->lock);
+    f = farm->free_frames;
+    if (f) {
+        farm->free_frames = f->next;
+    }
+    pthread_mutex_unlock(&farm->lock);
+
+    if (!f) {
+        /* writer fell behind, grow the pool rather than wait for it */
+        f = calloc(1, sizeof(*f));
+        if (f) {
+            f->pixels = malloc(farm->frame_size);
+        }
+        if (!f || !f->pixels) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    return f;
+}
+
+static void frame_put(struct farm *farm, struct frame *f) {
+    pthread_mutex_lock(&farm->lock);
+    f->next = farm->free_frames;
+    farm->free_frames = f;
+    pthread_mutex_unlock(&farm->lock);
+}
+
+static void frame_done(struct farm *farm, struct frame *f) {
+    f->next = NULL;
+    pthread_mutex_lock(&farm->lock);
+    *farm->written_tail = f;
+    farm->written_tail = &f->next;
+    pthread_cond_signal(&farm->ready);
+    pthread_mutex_unlock(&farm->lock);
+}
+
+static int pop_job(struct deque *q, struct job *job) {
+    int ok = 0;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        *job = q->jobs[--q->tail];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+static int steal_job(struct deque *q, struct job *job) {
+    int ok = 0;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        *job = q->jobs[q->head++];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+/* jobs are all queued up front, so one empty pass over the queues means done */
+static int next_job(struct worker *w, struct job *job) {
+    struct farm *farm = w->farm;
+    int i;
+
+    if (pop_job(&w->queue, job)) {
+        return 1;
+    }
+    for (i = 1; i < farm->num_workers; i++) {
+        struct worker *victim = &farm->workers[(w->id + i) % farm->num_workers];
+        if (steal_job(&victim->queue, job)) {
+            w->steals++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = arg;
+    struct farm *farm = w->farm;
+    OSMesaContext ctx;
+    struct scenes scenes;
+    struct job job;
+    double t;
+
+    ctx = OSMesaCreateContextExt(OSMESA_RGBA, 16, 0, 0, NULL);
+    if (!ctx) {
+        fprintf(stderr, "worker %d: OSMesaCreateContextExt() failed!\n", w->id);
+        exit(1);
+    }
+    w->frame = frame_get(farm);
+    /* any size will do to make the context current for setup */
+    if (!OSMesaMakeCurrent(ctx, w->frame->pixels, GL_UNSIGNED_BYTE, 1, 1)) {
+        fprintf(stderr, "worker %d: OSMesaMakeCurrent failed!\n", w->id);
+        exit(1);
+    }
+    OSMesaColorClamp(GL_TRUE);
+    scenes_init(&scenes);
+
+    pthread_barrier_wait(&farm->start);
+
+    t = w->started = now();
+    while (next_job(w, &job)) {
+        double t1 = now();
+        w->idle += t1 - t;
+
+        OSMesaMakeCurrent(ctx, w->frame->pixels, GL_UNSIGNED_BYTE, job.width, job.height);
+        scenes_draw(&scenes, job.scene, job.angle, job.width, job.height);
+        glFinish();
+
+        w->frame->job = job;
+        frame_done(farm, w->frame);
+        w->frame = frame_get(farm);
+        w->frames++;
+
+        t = now();
+        w->busy += t - t1;
+    }
+    w->idle += now() - t;
+    w->finished = now();
+
+    scenes_free(&scenes);
+    OSMesaDestroyContext(ctx);
+    frame_put(farm, w->frame);
+
+    pthread_mutex_lock(&farm->lock);
+    farm->workers_left--;
+    pthread_cond_signal(&farm->ready);
+    pthread_mutex_unlock(&farm->lock);
+
+    return NULL;
+}
+
+static void write_ppm(const char *outdir, const struct frame *f) {
+    const struct job *job = &f->job;
+    char path[1024];
+    unsigned char *row;
+    FILE *fp;
+    int x, y;
+
+    snprintf(path, sizeof(path), "%s/%s_%04d.ppm", outdir, scene_name(job->scene), job->index);
+    fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "can't write %s\n", path);
+        return;
+    }
+    row = malloc(job->width * 3);
+    fprintf(fp, "P6\n%d %d\n255\n", job->width, job->height);
+    /* OSMesa rows go bottom up */
+    for (y = job->height - 1; y >= 0; y--) {
+        const GLubyte *src = f->pixels + (size_t) y * job->width * 4;
+        for (x = 0; x < job->width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        fwrite(row, 3, job->width, fp);
+    }
+    free(row);
+    fclose(fp);
+}
+
+static void *writer_main(void *arg) {
+    struct farm *farm = arg;
+
+    pthread_mutex_lock(&farm->lock);
+    for (;;) {
+        struct frame *f = farm->written_head;
+        if (!f) {
+            if (farm->workers_left == 0) {
+                break;
+            }
+            pthread_cond_wait(&farm->ready, &farm->lock);
+            continue;
+        }
+        farm->written_head = f->next;
+        if (!farm->written_head) {
+            farm->written_tail = &farm->written_head;
+        }
+        pthread_mutex_unlock(&farm->lock);
+
+        if (farm->outdir) {
+            write_ppm(farm->outdir, f);
+        }
+
+        pthread_mutex_lock(&farm->lock);
+        f->next = farm->free_frames;
+        farm->free_frames = f;
+    }
+    pthread_mutex_unlock(&farm->lock);
+
+    return NULL;
+}
+
+/* returns frames per second, rendering only (context setup excluded) */
+static double run(const struct job *jobs, int num_jobs, int num_workers, const char *outdir) {
+    struct farm farm;
+    pthread_t writer;
+    double elapsed, start = 0.0, end = 0.0;
+    int i, max_pixels = 0;
+
+    memset(&farm, 0, sizeof(farm));
+    farm.num_workers = num_workers;
+    farm.outdir = outdir;
+    farm.workers_left = num_workers;
+    farm.written_tail = &farm.written_head;
+    pthread_mutex_init(&farm.lock, NULL);
+    pthread_cond_init(&farm.ready, NULL);
+    pthread_barrier_init(&farm.start, NULL, num_workers + 1);
+
+    for (i = 0; i < num_jobs; i++) {
+        if (jobs[i].width * jobs[i].height > max_pixels) {
+            max_pixels = jobs[i].width * jobs[i].height;
+        }
+    }
+    farm.frame_size = (size_t) max_pixels * 4;
+
+    /* preallocate the buffers, frame_get only mallocs if they run out */
+    for (i = 0; i < num_workers * BUFFERS_PER_WORKER; i++) {
+        struct frame *f = calloc(1, sizeof(*f));
+        f->pixels = malloc(farm.frame_size);
+        frame_put(&farm, f);
+    }
+
+    farm.workers = calloc(num_workers, sizeof(*farm.workers));
+    for (i = 0; i < num_workers; i++) {
+        struct worker *w = &farm.workers[i];
+        w->id = i;
+        w->farm = &farm;
+        pthread_mutex_init(&w->queue.lock, NULL);
+        w->queue.jobs = malloc(num_jobs * sizeof(*jobs));
+    }
+    /* deal in reverse so each worker pops its jobs in order */
+    for (i = num_jobs - 1; i >= 0; i--) {
+        struct deque *q = &farm.workers[i % num_workers].queue;
+        q->jobs[q->tail++] = jobs[i];
+    }
+
+    pthread_create(&writer, NULL, writer_main, &farm);
+    for (i = 0; i < num_workers; i++) {
+        pthread_create(&farm.workers[i].thread, NULL, worker_main, &farm.workers[i]);
+    }
+
+    pthread_barrier_wait(&farm.start);
+
+    for (i = 0; i < num_workers; i++) {
+        struct worker *w = &farm.workers[i];
+        pthread_join(w->thread, NULL);
+        if (i == 0 || w->started < start) {
+            start = w->started;
+        }
+        if (w->finished > end) {
+            end = w->finished;
+        }
+    }
+    elapsed = end - start;
+    pthread_join(writer, NULL);
+
+    printf("worker  frames  steals   busy (s)   idle (s)\n");
+    for (i = 0; i < num_workers; i++) {
+        struct worker *w = &farm.workers[i];
+        /* a late start or waiting for the slowest worker counts as idle too */
+        w->idle += (w->started - start) + (end - w->finished);
+        printf("%6d  %6d  %6d  %9.3f  %9.3f\n", i, w->frames, w->steals, w->busy, w->idle);
+        pthread_mutex_destroy(&w->queue.lock);
+        free(w->queue.jobs);
+    }
+
+    while (farm.free_frames) {
+        struct frame *f = farm.free_frames;
+        farm.free_frames = f->next;
+        free(f->pixels);
+        free(f);
+    }
+    free(farm.workers);
+    pthread_barrier_destroy(&farm.start);
+    pthread_cond_destroy(&farm.ready);
+    pthread_mutex_destroy(&farm.lock);
+
+    return elapsed > 0.0 ? num_jobs / elapsed : 0.0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-j workers] [-s] [-n frames] [-r WxH] [-o dir] [-f file] [scene ...]\n",
+            argv0);
+    fprintf(stderr, "scenes: %s %s\n", scene_name(SCENE_OSTEST1), scene_name(SCENE_GEARS));
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    int num_workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int frames = 36, width = 960, height = 544, sweep = 0;
+    int scenes[NUM_SCENES], num_scenes = 0;
+    const char *outdir = NULL, *scene_file = OSTEST1_SCENE;
+    struct job *jobs;
+    int num_jobs, opt, i, j;
+
+    while ((opt = getopt(argc, argv, "j:sn:r:o:f:")) != -1) {
+        switch (opt) {
+            case 'j':
+                num_workers = atoi(optarg);
+                break;
+            case 's':
+                sweep = 1;
+                break;
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'r':
+                if (sscanf(optarg, "%dx%d", &width, &height) != 2) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'o':
+                outdir = optarg;
+                break;
+            case 'f':
+                scene_file = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (num_workers < 1 || frames < 1 || width < 1 || height < 1) {
+        usage(argv[0]);
+    }
+    /* each scene once, so there are never more than NUM_SCENES */
+    for (i = optind; i < argc; i++) {
+        int scene = scene_find(argv[i]);
+        if (scene < 0) {
+            usage(argv[0]);
+        }
+        for (j = 0; j < num_scenes && scenes[j] != scene; j++) {
+        }
+        if (j < num_scenes) {
+            fprintf(stderr, "%s given twice\n", argv[i]);
+            return 1;
+        }
+        scenes[num_scenes++] = scene;
+    }
+    if (num_scenes == 0) {
+        for (i = 0; i < NUM_SCENES; i++) {
+            scenes[num_scenes++] = i;
+        }
+    }
+    for (i = 0; i < num_scenes; i++) {
+        if (scenes[i] == SCENE_OSTEST1 && !scenes_load(scene_file)) {
+            fprintf(stderr, "can't load %s\n", scene_file);
+            return 1;
+        }
+    }
+    if (outdir && mkdir(outdir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "can't create %s\n", outdir);
+        return 1;
+    }
+
+    /* a turntable sequence per scene */
+    num_jobs = num_scenes * frames;
+    jobs = malloc(num_jobs * sizeof(*jobs));
+    for (i = 0; i < num_scenes; i++) {
+        for (j = 0; j < frames; j++) {
+            struct job *job = &jobs[i * frames + j];
+            job->scene = scenes[i];
+            job->index = j;
+            job->angle = 360.0 * j / frames;
+            job->width = width;
+            job->height = height;
+        }
+    }
+
+    printf("%d frames at %dx%d\n", num_jobs, width, height);
+    if (sweep) {
+        double *fps = calloc(num_workers + 1, sizeof(*fps));
+        for (i = 1; i <= num_workers; i++) {
+            fps[i] = run(jobs, num_jobs, i, outdir);
+            printf("%d workers: %.2f fps\n\n", i, fps[i]);
+        }
+        printf("workers      fps  speedup\n");
+        for (i = 1; i <= num_workers; i++) {
+            printf("%7d  %7.2f  %7.2f\n", i, fps[i], fps[1] > 0.0 ? fps[i] / fps[1] : 0.0);
+        }
+        free(fps);
+    } else {
+        double fps = run(jobs, num_jobs, num_workers, outdir);
+        printf("%d workers: %.2f fps\n", num_workers, fps);
+    }
+
+    free(jobs);
+    scenes_unload();
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <string.h>
+#include <GL/gl.h>
+
+#include "gear.h"
+#include "scenes.h"
+#include "view.h"
+
+static const char *names[NUM_SCENES] = {
+        "ostest1",
+        "gears",
+};
+
+int scene_find(const char *name) {
+    int i;
+
+    for (i = 0; i < NUM_SCENES; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *scene_name(int scene) {
+    return names[scene];
+}
+
+/* the ostest1 scene file, shared read only by all workers */
+static struct scene ostest1_file;
+
+int scenes_load(const char *ostest1_path) {
+    return scene_load(&ostest1_file, ostest1_path);
+}
+
+void scenes_unload(void) {
+    scene_free(&ostest1_file);
+}
+
+void scenes_init(struct scenes *s) {
+    static const GLfloat red[4] = {0.8, 0.1, 0.0, 1.0};
+    static const GLfloat green[4] = {0.0, 0.8, 0.2, 1.0};
+    static const GLfloat blue[4] = {0.2, 0.2, 1.0, 1.0};
+
+    /* textures are per context, the file they come from is not */
+    s->ostest1 = ostest1_file;
+    s->ostest1.texture_names = NULL;
+    if (s->ostest1.base) {
+        scene_upload_textures(&s->ostest1);
+    }
+
+    /* same gears as the gears sample init() */
+    s->gears = glGenLists(3);
+    glNewList(s->gears, GL_COMPILE);
+    glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, red);
+    gear(1.0, 4.0, 1.0, 20, 0.7);
+    glEndList();
+    glNewList(s->gears + 1, GL_COMPILE);
+    glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, green);
+    gear(0.5, 2.0, 2.0, 10, 0.7);
+    glEndList();
+    glNewList(s->gears + 2, GL_COMPILE);
+    glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, blue);
+    gear(1.3, 2.0, 0.5, 10, 0.7);
+    glEndList();
+}
+
+void scenes_free(struct scenes *s) {
+    scene_free_textures(&s->ostest1);
+    glDeleteLists(s->gears, 3);
+}
+
+/* ostest1's view and light around the objects of its scene file */
+static void draw_ostest1(const struct scenes *s, float angle) {
+    static const GLfloat light_ambient[4] = VIEW_LIGHT_AMBIENT;
+    static const GLfloat light_diffuse[4] = VIEW_LIGHT_DIFFUSE;
+    static const GLfloat light_specular[4] = VIEW_LIGHT_SPECULAR;
+    static const GLfloat light_position[4] = VIEW_LIGHT_POSITION;
+    static const GLfloat model_ambient[4] = VIEW_MODEL_AMBIENT;
+    static const GLfloat translate[3] = VIEW_TRANSLATE;
+    const struct scene *file = &s->ostest1;
+    uint32_t i;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustum(VIEW_FRUSTUM);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glLightfv(GL_LIGHT0, GL_AMBIENT, light_ambient);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
+    glLightfv(GL_LIGHT0, GL_SPECULAR, light_specular);
+    glLightfv(GL_LIGHT0, GL_POSITION, light_position);
+    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, model_ambient);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_DEPTH_TEST);
+
+    glClearColor(VIEW_CLEAR_COLOR);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glTranslatef(translate[0], translate[1], translate[2]);
+    glRotatef(VIEW_ROTX, 1.0, 0.0, 0.0);
+    glRotatef(angle, 0.0, 1.0, 0.0);
+
+    for (i = 0; file->base && i < file->header->num_objects; i++) {
+        const struct scn_object *o = &file->objects[i];
+        const struct scn_material *mat = &file->materials[o->material];
+
+        if (mat->flags & SCN_LIT) {
+            glEnable(GL_LIGHTING);
+            glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, mat->color);
+        } else {
+            glDisable(GL_LIGHTING);
+            glColor4fv(mat->color);
+        }
+
+        glPushMatrix();
+        glTranslatef(o->translate[0], o->translate[1], o->translate[2]);
+        if (o->rotate[0] != 0.0) {
+            glRotatef(o->rotate[0], o->rotate[1], o->rotate[2], o->rotate[3]);
+        }
+        scene_draw_material_mesh(file, &file->meshes[o->mesh], mat,
+                                 o->texture == SCN_NO_TEXTURE ? 0 : file->texture_names[o->texture], NULL);
+        glPopMatrix();
+    }
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+}
+
+static void draw_gears(const struct scenes *s, float angle, int width, int height) {
+    static const GLfloat pos[4] = {5.0, 5.0, 10.0, 0.0};
+    GLfloat h = (GLfloat) height / (GLfloat) width;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustum(-1.0, 1.0, -h, h, 5.0, 200.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glLightfv(GL_LIGHT0, GL_POSITION, pos);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_NORMALIZE);
+
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glTranslatef(0.0, 0.0, -60.0);
+    glRotatef(20.0, 1.0, 0.0, 0.0);
+    glRotatef(30.0 + angle, 0.0, 1.0, 0.0);
+
+    glPushMatrix();
+    glTranslatef(-3.0, -2.0, 0.0);
+    glCallList(s->gears);
+    glPopMatrix();
+
+    glPushMatrix();
+    glTranslatef(3.1, -2.0, 0.0);
+    glRotatef(-9.0, 0.0, 0.0, 1.0);
+    glCallList(s->gears + 1);
+    glPopMatrix();
+
+    glPushMatrix();
+    glTranslatef(-3.1, 4.2, 0.0);
+    glRotatef(-25.0, 0.0, 0.0, 1.0);
+    glCallList(s->gears + 2);
+    glPopMatrix();
+
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_NORMALIZE);
+}
+
+void scenes_draw(const struct scenes *s, int scene, float angle, int width, int height) {
+    glViewport(0, 0, width, height);
+
+    switch (scene) {
+        case SCENE_OSTEST1:
+            draw_ostest1(s, angle);
+            break;
+        case SCENE_GEARS:
+            draw_gears(s, angle, width, height);
+            break;
+        default:
+            break;
+    }
+}
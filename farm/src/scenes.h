@@ -0,0 +1,38 @@
+#ifndef SCENES_H
+#define SCENES_H
+
+#include <GL/gl.h>
+
+#include "scene.h"
+
+enum {
+    SCENE_OSTEST1, SCENE_GEARS, NUM_SCENES
+};
+
+/* per context objects, display lists and textures are not shared */
+struct scenes {
+    struct scene ostest1;       /* the shared file with this context's textures */
+    GLuint gears;
+};
+
+int scene_find(const char *name);
+
+const char *scene_name(int scene);
+
+/**
+ * Load the ostest1 scene file (see tools/scenec), before any scenes_init().
+ * Returns 1 on success, 0 on failure.
+ */
+int scenes_load(const char *ostest1_path);
+
+void scenes_unload(void);
+
+/* needs a current context */
+void scenes_init(struct scenes *s);
+
+/* draw a scene turned by angle degrees around the vertical axis */
+void scenes_draw(const struct scenes *s, int scene, float angle, int width, int height);
+
+void scenes_free(struct scenes *s);
+
+#endif /* SCENES_H */
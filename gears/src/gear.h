@@ -0,0 +1,10 @@
+#ifndef GEAR_H
+#define GEAR_H
+
+#include <GL/gl.h>
+
+void
+gear(GLfloat inner_radius, GLfloat outer_radius, GLfloat width,
+     GLint teeth, GLfloat tooth_depth);
+
+#endif /* GEAR_H */
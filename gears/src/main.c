@@ -11,6 +11,12 @@
 #include <vita2d.h>
 #include <psp2shell.h>
 
+#ifdef BAKED_MESHES
+#include "baked_meshes.h"
+#else
+#include "gear.h"
+#endif
+
 #define printf psp2shell_print
 
 #define WIDTH 960
@@ -22,6 +28,7 @@ static OSMesaContext ctx = NULL;
 static void gl_swap();
 
 struct timeval start;
+static struct timeval launch;
 #define GLUT_ELAPSED_TIME 0
 
 int glutGet(GLenum state) {
@@ -40,145 +47,11 @@ int glutGet(GLenum state) {
     return 0;
 }
 
-#ifndef M_PI
-#define M_PI 3.14159265
-#endif
-
 static GLint T0 = 0;
 static GLint Frames = 0;
 static GLint autoexit = 0;
 static GLfloat viewDist = 60.0;
 
-/**
-
-  Draw a gear wheel.  You'll probably want to call this function when
-  building a display list since we do a lot of trig here.
-
-  Input:  inner_radius - radius of hole at center
-          outer_radius - radius at center of teeth
-          width - width of gear
-          teeth - number of teeth
-          tooth_depth - depth of tooth
-
- **/
-
-static void
-gear(GLfloat inner_radius, GLfloat outer_radius, GLfloat width,
-     GLint teeth, GLfloat tooth_depth) {
-    GLint i;
-    GLfloat r0, r1, r2;
-    GLfloat angle, da;
-    GLfloat u, v, len;
-
-    r0 = inner_radius;
-    r1 = outer_radius - tooth_depth / 2.0;
-    r2 = outer_radius + tooth_depth / 2.0;
-
-    da = 2.0 * M_PI / teeth / 4.0;
-
-    glShadeModel(GL_FLAT);
-
-    glNormal3f(0.0, 0.0, 1.0);
-
-    /* draw front face */
-    glBegin(GL_QUAD_STRIP);
-    for (i = 0; i <= teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-        glVertex3f(r0 * cos(angle), r0 * sin(angle), width * 0.5);
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), width * 0.5);
-        if (i < teeth) {
-            glVertex3f(r0 * cos(angle), r0 * sin(angle), width * 0.5);
-            glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), width * 0.5);
-        }
-    }
-    glEnd();
-
-    /* draw front sides of teeth */
-    glBegin(GL_QUADS);
-    da = 2.0 * M_PI / teeth / 4.0;
-    for (i = 0; i < teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), width * 0.5);
-        glVertex3f(r2 * cos(angle + da), r2 * sin(angle + da), width * 0.5);
-        glVertex3f(r2 * cos(angle + 2 * da), r2 * sin(angle + 2 * da), width * 0.5);
-        glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), width * 0.5);
-    }
-    glEnd();
-
-    glNormal3f(0.0, 0.0, -1.0);
-
-    /* draw back face */
-    glBegin(GL_QUAD_STRIP);
-    for (i = 0; i <= teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), -width * 0.5);
-        glVertex3f(r0 * cos(angle), r0 * sin(angle), -width * 0.5);
-        if (i < teeth) {
-            glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), -width * 0.5);
-            glVertex3f(r0 * cos(angle), r0 * sin(angle), -width * 0.5);
-        }
-    }
-    glEnd();
-
-    /* draw back sides of teeth */
-    glBegin(GL_QUADS);
-    da = 2.0 * M_PI / teeth / 4.0;
-    for (i = 0; i < teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-
-        glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), -width * 0.5);
-        glVertex3f(r2 * cos(angle + 2 * da), r2 * sin(angle + 2 * da), -width * 0.5);
-        glVertex3f(r2 * cos(angle + da), r2 * sin(angle + da), -width * 0.5);
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), -width * 0.5);
-    }
-    glEnd();
-
-    /* draw outward faces of teeth */
-    glBegin(GL_QUAD_STRIP);
-    for (i = 0; i < teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), width * 0.5);
-        glVertex3f(r1 * cos(angle), r1 * sin(angle), -width * 0.5);
-        u = r2 * cos(angle + da) - r1 * cos(angle);
-        v = r2 * sin(angle + da) - r1 * sin(angle);
-        len = sqrt(u * u + v * v);
-        u /= len;
-        v /= len;
-        glNormal3f(v, -u, 0.0);
-        glVertex3f(r2 * cos(angle + da), r2 * sin(angle + da), width * 0.5);
-        glVertex3f(r2 * cos(angle + da), r2 * sin(angle + da), -width * 0.5);
-        glNormal3f(cos(angle), sin(angle), 0.0);
-        glVertex3f(r2 * cos(angle + 2 * da), r2 * sin(angle + 2 * da), width * 0.5);
-        glVertex3f(r2 * cos(angle + 2 * da), r2 * sin(angle + 2 * da), -width * 0.5);
-        u = r1 * cos(angle + 3 * da) - r2 * cos(angle + 2 * da);
-        v = r1 * sin(angle + 3 * da) - r2 * sin(angle + 2 * da);
-        glNormal3f(v, -u, 0.0);
-        glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), width * 0.5);
-        glVertex3f(r1 * cos(angle + 3 * da), r1 * sin(angle + 3 * da), -width * 0.5);
-        glNormal3f(cos(angle), sin(angle), 0.0);
-    }
-
-    glVertex3f(r1 * cos(0), r1 * sin(0), width * 0.5);
-    glVertex3f(r1 * cos(0), r1 * sin(0), -width * 0.5);
-
-    glEnd();
-
-    glShadeModel(GL_SMOOTH);
-
-    /* draw inside radius cylinder */
-    glBegin(GL_QUAD_STRIP);
-    for (i = 0; i <= teeth; i++) {
-        angle = i * 2.0 * M_PI / teeth;
-        glNormal3f(-cos(angle), -sin(angle), 0.0);
-        glVertex3f(r0 * cos(angle), r0 * sin(angle), -width * 0.5);
-        glVertex3f(r0 * cos(angle), r0 * sin(angle), width * 0.5);
-    }
-    glEnd();
-
-}
-
 static GLfloat view_rotx = 20.0, view_roty = 30.0, view_rotz = 0.0;
 static GLint gear1, gear2, gear3;
 static GLfloat angle = 0.0;
@@ -224,6 +97,14 @@ draw(void) {
 
     gl_swap();
 
+    if (launch.tv_sec) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        printf("first frame presented %.3f ms after main()\n",
+               (now.tv_sec - launch.tv_sec) * 1000.0 + (now.tv_usec - launch.tv_usec) / 1000.0);
+        launch.tv_sec = 0;
+    }
+
     Frames++;
 
     {
@@ -287,19 +168,31 @@ init() {
     gear1 = glGenLists(1);
     glNewList(gear1, GL_COMPILE);
     glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, red);
+#ifdef BAKED_MESHES
+    draw_baked_mesh(&baked_gear1, NULL);
+#else
     gear(1.0, 4.0, 1.0, 20, 0.7);
+#endif
     glEndList();
 
     gear2 = glGenLists(1);
     glNewList(gear2, GL_COMPILE);
     glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, green);
+#ifdef BAKED_MESHES
+    draw_baked_mesh(&baked_gear2, NULL);
+#else
     gear(0.5, 2.0, 2.0, 10, 0.7);
+#endif
     glEndList();
 
     gear3 = glGenLists(1);
     glNewList(gear3, GL_COMPILE);
     glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, blue);
+#ifdef BAKED_MESHES
+    draw_baked_mesh(&baked_gear3, NULL);
+#else
     gear(1.3, 2.0, 0.5, 10, 0.7);
+#endif
     glEndList();
 
     glEnable(GL_NORMALIZE);
@@ -379,6 +272,8 @@ static int gl_exit() {
 
 int main(int argc, char *argv[]) {
 
+    gettimeofday(&launch, NULL);
+
     psp2shell_init(3333, 5);
     printf("Hello, (GL)world!\n");
 
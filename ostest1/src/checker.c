@@ -0,0 +1,21 @@
+#include "checker.h"
+
+void Checker(unsigned char *texels, int width, int height) {
+    int i, j;
+
+    for (i = 0; i < height; i++) {
+        for (j = 0; j < width; j++) {
+            unsigned char *p = texels + (i * width + j) * 4;
+            unsigned char c;
+            if ((i % 5) == 0 || (j % 5) == 0) {
+                c = 200;
+            } else if ((i % 5) == 1 || (j % 5) == 1) {
+                c = 50;
+            } else {
+                c = 100;
+            }
+            p[0] = p[1] = p[2] = c;
+            p[3] = 255;
+        }
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef CHECKER_H
+#define CHECKER_H
+
+/**
+ * The ostest1 ground texture: grey RGBA8 checker lines every 5 texels.
+ * Shared so every program drawing the ostest1 scene uses the same texels.
+ */
+void Checker(unsigned char *texels, int width, int height);
+
+#endif /* CHECKER_H */
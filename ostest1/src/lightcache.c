@@ -0,0 +1,133 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lightcache.h"
+
+static GLubyte to_ubyte(GLfloat x) {
+    if (x <= 0.0) {
+        return 0;
+    }
+    if (x >= 1.0) {
+        return 255;
+    }
+    return (GLubyte) (x * 255.0 + 0.5);
+}
+
+/* the fixed function equation for one light, local viewer and two sided off */
+static void light_vertices(struct light_cache *c, const GLfloat *vertices,
+                           int stride, int normal_offset, int count) {
+    const GLfloat *mv = c->key.modelview;
+    const struct light_params *light = &c->key.light;
+    const GLfloat *mat = c->key.material;
+    GLfloat nm[9], base[3], diffuse[3], dir[3] = {0.0, 0.0, 0.0}, det;
+    int positional = light->position[3] != 0.0;
+    int i, k;
+
+    /* normal matrix, cofactors of the upper 3x3 scaled by the sign of det */
+    nm[0] = mv[5] * mv[10] - mv[6] * mv[9];
+    nm[1] = mv[6] * mv[8] - mv[4] * mv[10];
+    nm[2] = mv[4] * mv[9] - mv[5] * mv[8];
+    nm[3] = mv[9] * mv[2] - mv[10] * mv[1];
+    nm[4] = mv[10] * mv[0] - mv[8] * mv[2];
+    nm[5] = mv[8] * mv[1] - mv[9] * mv[0];
+    nm[6] = mv[1] * mv[6] - mv[2] * mv[5];
+    nm[7] = mv[2] * mv[4] - mv[0] * mv[6];
+    nm[8] = mv[0] * mv[5] - mv[1] * mv[4];
+    det = mv[0] * nm[0] + mv[1] * nm[1] + mv[2] * nm[2];
+    if (det < 0.0) {
+        for (k = 0; k < 9; k++) {
+            nm[k] = -nm[k];
+        }
+    }
+
+    for (k = 0; k < 3; k++) {
+        base[k] = (light->model_ambient[k] + light->ambient[k]) * mat[k];
+        diffuse[k] = light->diffuse[k] * mat[k];
+    }
+    if (!positional) {
+        GLfloat len = sqrt(light->position[0] * light->position[0]
+                           + light->position[1] * light->position[1]
+                           + light->position[2] * light->position[2]);
+        for (k = 0; k < 3 && len > 0.0; k++) {
+            dir[k] = light->position[k] / len;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        const GLfloat *p = vertices + i * stride;
+        const GLfloat *n = p + normal_offset;
+        GLubyte *out = c->colors + i * 4;
+        GLfloat ne[3], len, ndotl;
+
+        /* nm rows are the cofactors of the columns of the 3x3 */
+        ne[0] = nm[0] * n[0] + nm[3] * n[1] + nm[6] * n[2];
+        ne[1] = nm[1] * n[0] + nm[4] * n[1] + nm[7] * n[2];
+        ne[2] = nm[2] * n[0] + nm[5] * n[1] + nm[8] * n[2];
+        len = sqrt(ne[0] * ne[0] + ne[1] * ne[1] + ne[2] * ne[2]);
+
+        if (positional) {
+            GLfloat pe[3];
+            for (k = 0; k < 3; k++) {
+                pe[k] = mv[k] * p[0] + mv[4 + k] * p[1] + mv[8 + k] * p[2] + mv[12 + k];
+                dir[k] = light->position[k] / light->position[3] - pe[k];
+            }
+            ndotl = sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+            if (ndotl > 0.0) {
+                len *= ndotl;
+            }
+        }
+
+        ndotl = ne[0] * dir[0] + ne[1] * dir[1] + ne[2] * dir[2];
+        ndotl = (len > 0.0 && ndotl > 0.0) ? ndotl / len : 0.0;
+
+        for (k = 0; k < 3; k++) {
+            out[k] = to_ubyte(base[k] + ndotl * diffuse[k]);
+        }
+        out[3] = to_ubyte(mat[3]);
+    }
+}
+
+const GLubyte *light_cache_colors(struct light_cache *c, const struct light_params *light,
+                                  const GLfloat material[4], const GLfloat *vertices,
+                                  int stride, int normal_offset, int count) {
+    GLfloat mv[16];
+
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+
+    if (c->valid && c->num_vertices == count
+        && memcmp(c->key.modelview, mv, sizeof(mv)) == 0
+        && memcmp(&c->key.light, light, sizeof(*light)) == 0
+        && memcmp(c->key.material, material, sizeof(c->key.material)) == 0) {
+        c->hits++;
+        return c->colors;
+    }
+
+    c->misses++;
+    if (c->num_vertices != count || !c->colors) {
+        free(c->colors);
+        c->colors = malloc(count * 4);
+        c->num_vertices = count;
+        if (!c->colors) {
+            c->valid = 0;
+            return NULL;
+        }
+    }
+
+    memcpy(c->key.modelview, mv, sizeof(mv));
+    memcpy(&c->key.light, light, sizeof(*light));
+    memcpy(c->key.material, material, sizeof(c->key.material));
+    light_vertices(c, vertices, stride, normal_offset, count);
+    c->valid = 1;
+
+    return c->colors;
+}
+
+void light_cache_invalidate(struct light_cache *c) {
+    c->valid = 0;
+}
+
+void light_cache_free(struct light_cache *c) {
+    free(c->colors);
+    memset(c, 0, sizeof(*c));
+}
@@ -0,0 +1,44 @@
+#ifndef LIGHTCACHE_H
+#define LIGHTCACHE_H
+
+#include <GL/gl.h>
+
+/* GL_LIGHT0 as set up by the sample, position in eye space */
+struct light_params {
+    GLfloat model_ambient[4];
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat position[4];
+};
+
+/**
+ * Per object vertex colors, lit once and reused while the light, the
+ * material and the object's modelview stay the same.
+ */
+struct light_cache {
+    struct {
+        GLfloat modelview[16];
+        struct light_params light;
+        GLfloat material[4];
+    } key;
+    GLubyte *colors;            /* RGBA per vertex */
+    int num_vertices;
+    int valid;
+    unsigned int hits, misses;
+};
+
+/**
+ * Colors for count vertices (position at 0, normal at normal_offset, both
+ * in floats, stride floats apart) lit under the current modelview, with
+ * material as ambient and diffuse and no specular or emission. Only
+ * recomputed when something in the key changed.
+ */
+const GLubyte *light_cache_colors(struct light_cache *c, const struct light_params *light,
+                                  const GLfloat material[4], const GLfloat *vertices,
+                                  int stride, int normal_offset, int count);
+
+void light_cache_invalidate(struct light_cache *c);
+
+void light_cache_free(struct light_cache *c);
+
+#endif /* LIGHTCACHE_H */
@@ -2,6 +2,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <GL/osmesa.h>
 #include <GL/glu.h>
 
@@ -10,6 +11,16 @@
 #include <vita2d.h>
 #include <psp2shell.h>
 
+#include "checker.h"
+#include "lightcache.h"
+#include "scene.h"
+#include "view.h"
+#ifdef BAKED_MESHES
+#include "baked_meshes.h"
+#else
+#include "shapes.h"
+#endif
+
 #define printf psp2shell_print
 
 #define WIDTH 960
@@ -18,6 +29,8 @@
 static vita2d_texture *vtex = NULL;
 static OSMesaContext ctx = NULL;
 
+#ifndef BAKED_MESHES
+
 static void Sphere(float radius, int slices, int stacks) {
     GLUquadric *q = gluNewQuadric();
     gluQuadricNormals(q, GLU_SMOOTH);
@@ -34,94 +47,7 @@ static void Cone(float base, float height, int slices, int stacks) {
     gluDeleteQuadric(q);
 }
 
-
-static void Torus(float innerRadius, float outerRadius, int sides, int rings) {
-    /* from GLUT... */
-    int i, j;
-    GLfloat theta, phi, theta1;
-    GLfloat cosTheta, sinTheta;
-    GLfloat cosTheta1, sinTheta1;
-    const GLfloat ringDelta = 2.0 * M_PI / rings;
-    const GLfloat sideDelta = 2.0 * M_PI / sides;
-
-    theta = 0.0;
-    cosTheta = 1.0;
-    sinTheta = 0.0;
-    for (i = rings - 1; i >= 0; i--) {
-        theta1 = theta + ringDelta;
-        cosTheta1 = cos(theta1);
-        sinTheta1 = sin(theta1);
-        glBegin(GL_QUAD_STRIP);
-        phi = 0.0;
-        for (j = sides; j >= 0; j--) {
-            GLfloat cosPhi, sinPhi, dist;
-
-            phi += sideDelta;
-            cosPhi = cos(phi);
-            sinPhi = sin(phi);
-            dist = outerRadius + innerRadius * cosPhi;
-
-            glNormal3f(cosTheta1 * cosPhi, -sinTheta1 * cosPhi, sinPhi);
-            glVertex3f(cosTheta1 * dist, -sinTheta1 * dist, innerRadius * sinPhi);
-            glNormal3f(cosTheta * cosPhi, -sinTheta * cosPhi, sinPhi);
-            glVertex3f(cosTheta * dist, -sinTheta * dist, innerRadius * sinPhi);
-        }
-        glEnd();
-        theta = theta1;
-        cosTheta = cosTheta1;
-        sinTheta = sinTheta1;
-    }
-}
-
-
-static void Cube(float size) {
-    size = 0.5 * size;
-
-    glBegin(GL_QUADS);
-    /* +X face */
-    glNormal3f(1, 0, 0);
-    glVertex3f(size, -size, size);
-    glVertex3f(size, -size, -size);
-    glVertex3f(size, size, -size);
-    glVertex3f(size, size, size);
-
-    /* -X face */
-    glNormal3f(-1, 0, 0);
-    glVertex3f(-size, size, size);
-    glVertex3f(-size, size, -size);
-    glVertex3f(-size, -size, -size);
-    glVertex3f(-size, -size, size);
-
-    /* +Y face */
-    glNormal3f(0, 1, 0);
-    glVertex3f(-size, size, size);
-    glVertex3f(size, size, size);
-    glVertex3f(size, size, -size);
-    glVertex3f(-size, size, -size);
-
-    /* -Y face */
-    glNormal3f(0, -1, 0);
-    glVertex3f(-size, -size, -size);
-    glVertex3f(size, -size, -size);
-    glVertex3f(size, -size, size);
-    glVertex3f(-size, -size, size);
-
-    /* +Z face */
-    glNormal3f(0, 0, 1);
-    glVertex3f(-size, -size, size);
-    glVertex3f(size, -size, size);
-    glVertex3f(size, size, size);
-    glVertex3f(-size, size, size);
-
-    /* -Z face */
-    glNormal3f(0, 0, -1);
-    glVertex3f(-size, size, -size);
-    glVertex3f(size, size, -size);
-    glVertex3f(size, -size, -size);
-    glVertex3f(-size, -size, -size);
-
-    glEnd();
-}
+#endif
 
 
 /**
@@ -151,40 +77,72 @@ static void render_gradient(void) {
 }
 
 
-static void render_image(void) {
-    static const GLfloat light_ambient[4] = {0.0, 0.0, 0.0, 1.0};
-    static const GLfloat light_diffuse[4] = {1.0, 1.0, 1.0, 1.0};
-    static const GLfloat light_specular[4] = {1.0, 1.0, 1.0, 1.0};
-    static const GLfloat light_position[4] = {1.0, 1.0, 1.0, 0.0};
-    static const GLfloat red_mat[4] = {1.0, 0.2, 0.2, 1.0};
-    static const GLfloat green_mat[4] = {0.2, 1.0, 0.2, 1.0};
-    static const GLfloat blue_mat[4] = {0.2, 0.2, 1.0, 1.0};
-#if 0
-    static const GLfloat yellow_mat[4]  = { 0.8, 0.8, 0.0, 1.0 };
+/**
+ * Scene inputs. Everything render_image() depends on lives here so a frame
+ * can be compared against the one currently held in the buffer.
+ */
+struct scene_object {
+    void (*draw)(const struct scene_object *obj);
+    GLfloat translate[3];
+    GLfloat rotate[4];      /* angle, x, y, z */
+    GLfloat material[4];
+    GLfloat radius;         /* object space bounding radius */
+    GLboolean lit;
+    /* objects from a scene file */
+    const struct scn_mesh *mesh;
+    const struct scn_material *mat;
+    GLuint texture;
+    struct light_cache *cache;  /* baked lighting, NULL when there are no vertex arrays */
+};
+
+struct scene_state {
+    GLfloat light_ambient[4];
+    GLfloat light_diffuse[4];
+    GLfloat light_specular[4];
+    GLfloat light_position[4];
+    GLfloat light_model_ambient[4];
+    GLfloat view_translate[3];
+    GLfloat view_rotx;
+    GLuint texture_serial;
+};
+
+struct rect {
+    GLint x0, y0, x1, y1;   /* window coords, x1/y1 exclusive */
+};
+
+/* set to 0 to always light lit objects with GL_LIGHTING */
+#ifndef BAKED_LIGHTING
+#define BAKED_LIGHTING 1
 #endif
-    static const GLfloat purple_mat[4] = {0.8, 0.4, 0.8, 0.6};
-
-    glLightfv(GL_LIGHT0, GL_AMBIENT, light_ambient);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, light_diffuse);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, light_specular);
-    glLightfv(GL_LIGHT0, GL_POSITION, light_position);
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHT0);
+static int baked_lighting = BAKED_LIGHTING;
+static struct light_params baked_light;
+static unsigned int drawn_vertices;     /* unique vertices, what baking lights */
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glFrustum(-1.0, 1.0, -1.0, 1.0, 2.0, 50.0);
-    glMatrixMode(GL_MODELVIEW);
-    glTranslatef(0, 0.5, -7);
+/**
+ * Per vertex colors of a lit object under the current modelview, or NULL
+ * when the object is lit by GL. On success lighting is disabled, the caller
+ * draws with the colors as a color array and calls unbake_lighting().
+ */
+static const GLubyte *bake_lighting(const struct scene_object *obj, const GLfloat *vertices,
+                                    int stride, int count) {
+    const GLubyte *colors;
 
-    glClearColor(0.3, 0.3, 0.7, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (!baked_lighting || !obj->lit || !obj->cache) {
+        return NULL;
+    }
+    colors = light_cache_colors(obj->cache, &baked_light, obj->material, vertices, stride, 3, count);
+    if (colors) {
+        glDisable(GL_LIGHTING);
+    }
+    return colors;
+}
 
-    glPushMatrix();
-    glRotatef(20.0, 1.0, 0.0, 0.0);
+static void unbake_lighting(void) {
+    glEnable(GL_LIGHTING);
+}
 
-    /* ground */
+static void draw_ground(const struct scene_object *obj) {
     glEnable(GL_TEXTURE_2D);
     glBegin(GL_POLYGON);
     glNormal3f(0, 1, 0);
@@ -198,48 +156,282 @@ static void render_image(void) {
     glVertex3f(-5, -1, 5);
     glEnd();
     glDisable(GL_TEXTURE_2D);
+}
 
-    glEnable(GL_LIGHTING);
+#ifdef BAKED_MESHES
 
-    glPushMatrix();
-    glTranslatef(-1.5, 0.5, 0.0);
-    glRotatef(90.0, 1.0, 0.0, 0.0);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, red_mat);
+/* draw a mesh baked by tools/meshgen, same primitives as the runtime path */
+static void draw_baked(const struct scene_object *obj, const struct baked_mesh *mesh) {
+    const GLubyte *colors = bake_lighting(obj, mesh->vertices, 6, mesh->num_vertices);
+
+    draw_baked_mesh(mesh, colors);
+    drawn_vertices += mesh->num_vertices;
+    if (colors) {
+        unbake_lighting();
+    }
+}
+
+#endif
+
+static void draw_torus(const struct scene_object *obj) {
+#ifdef BAKED_MESHES
+    draw_baked(obj, &baked_torus);
+#else
     Torus(0.275, 0.85, 20, 20);
-    glPopMatrix();
+#endif
+}
 
-    glPushMatrix();
-    glTranslatef(-1.5, -0.5, 0.0);
-    glRotatef(270.0, 1.0, 0.0, 0.0);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, green_mat);
+static void draw_cone(const struct scene_object *obj) {
+#ifdef BAKED_MESHES
+    draw_baked(obj, &baked_cone);
+#else
     Cone(1.0, 2.0, 16, 1);
-    glPopMatrix();
+#endif
+}
 
-    glPushMatrix();
-    glTranslatef(0.95, 0.0, -0.8);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, blue_mat);
+static void draw_sphere(const struct scene_object *obj) {
     glLineWidth(2.0);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+#ifdef BAKED_MESHES
+    draw_baked(obj, &baked_sphere);
+#else
     Sphere(1.2, 20, 20);
+#endif
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glPopMatrix();
+}
 
-    glPushMatrix();
-    glTranslatef(-0.25, 0.0, 2.5);
-    glRotatef(40, 0, 1, 0);
+static void draw_cube(const struct scene_object *obj) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
     glEnable(GL_CULL_FACE);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, purple_mat);
+#ifdef BAKED_MESHES
+    draw_baked(obj, &baked_cube);
+#else
     Cube(1.0);
+#endif
     glDisable(GL_BLEND);
     glDisable(GL_CULL_FACE);
+}
+
+static struct scene file_scene;
+
+static void draw_mesh(const struct scene_object *obj) {
+    const GLubyte *colors;
+
+    colors = bake_lighting(obj, (const GLfloat *) (file_scene.base + obj->mesh->vertices),
+                           sizeof(struct scn_vertex) / sizeof(GLfloat), obj->mesh->num_vertices);
+    scene_draw_material_mesh(&file_scene, obj->mesh, obj->mat, obj->texture, colors);
+    drawn_vertices += obj->mesh->num_vertices;
+    if (colors) {
+        unbake_lighting();
+    }
+}
+
+enum {
+    OBJ_GROUND, OBJ_TORUS, OBJ_CONE, OBJ_SPHERE, OBJ_CUBE, NUM_BUILTIN_OBJECTS
+};
+
+static struct scene_object builtin_objects[NUM_BUILTIN_OBJECTS] = {
+        [OBJ_GROUND] = {draw_ground, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0, 1.0},
+                        {1.0, 1.0, 1.0, 1.0}, 7.15, GL_FALSE},
+        [OBJ_TORUS] = {draw_torus, {-1.5, 0.5, 0.0}, {90.0, 1.0, 0.0, 0.0},
+                       {1.0, 0.2, 0.2, 1.0}, 1.125, GL_TRUE},
+        [OBJ_CONE] = {draw_cone, {-1.5, -0.5, 0.0}, {270.0, 1.0, 0.0, 0.0},
+                      {0.2, 1.0, 0.2, 1.0}, 2.24, GL_TRUE},
+        [OBJ_SPHERE] = {draw_sphere, {0.95, 0.0, -0.8}, {0.0, 0.0, 0.0, 1.0},
+                        {0.2, 0.2, 1.0, 1.0}, 1.2, GL_TRUE},
+        [OBJ_CUBE] = {draw_cube, {-0.25, 0.0, 2.5}, {40.0, 0.0, 1.0, 0.0},
+                      {0.8, 0.4, 0.8, 0.6}, 0.87, GL_TRUE},
+};
+
+#ifdef BAKED_MESHES
+static struct light_cache builtin_caches[NUM_BUILTIN_OBJECTS];
+#endif
+
+static struct scene_state state = {
+        VIEW_LIGHT_AMBIENT,
+        VIEW_LIGHT_DIFFUSE,
+        VIEW_LIGHT_SPECULAR,
+        VIEW_LIGHT_POSITION,
+        VIEW_MODEL_AMBIENT,
+        VIEW_TRANSLATE,
+        VIEW_ROTX,
+        0
+};
+
+static struct scene_object *objects;
+static int num_objects;
+
+/* what the buffer currently holds */
+static struct scene_object *drawn_objects;
+static struct scene_state drawn_state;
+static struct rect *drawn_rects;
+static struct rect *frame_rects;
+static GLboolean drawn_valid = GL_FALSE;
+
+/* lines and wireframes can spill a little outside the projected bounds */
+#define DIRTY_MARGIN 2
+
+static struct {
+    unsigned int frames;
+    unsigned int skipped;
+    double pixels;
+} stats;
+
+static void rect_clear(struct rect *r) {
+    r->x0 = r->y0 = 0;
+    r->x1 = r->y1 = 0;
+}
+
+static int rect_empty(const struct rect *r) {
+    return r->x1 <= r->x0 || r->y1 <= r->y0;
+}
+
+static void rect_union(struct rect *r, const struct rect *o) {
+    if (rect_empty(o)) {
+        return;
+    }
+    if (rect_empty(r)) {
+        *r = *o;
+        return;
+    }
+    if (o->x0 < r->x0) r->x0 = o->x0;
+    if (o->y0 < r->y0) r->y0 = o->y0;
+    if (o->x1 > r->x1) r->x1 = o->x1;
+    if (o->y1 > r->y1) r->y1 = o->y1;
+}
+
+static int rect_overlaps(const struct rect *r, const struct rect *o) {
+    return !rect_empty(r) && !rect_empty(o)
+           && r->x0 < o->x1 && o->x0 < r->x1
+           && r->y0 < o->y1 && o->y0 < r->y1;
+}
+
+static void setup_view(void) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustum(VIEW_FRUSTUM);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glTranslatef(state.view_translate[0], state.view_translate[1], state.view_translate[2]);
+    glRotatef(state.view_rotx, 1.0, 0.0, 0.0);
+}
+
+static void apply_transform(const struct scene_object *obj) {
+    glTranslatef(obj->translate[0], obj->translate[1], obj->translate[2]);
+    if (obj->rotate[0] != 0.0) {
+        glRotatef(obj->rotate[0], obj->rotate[1], obj->rotate[2], obj->rotate[3]);
+    }
+}
+
+/**
+ * Project the bounding box of an object to a window rectangle.
+ * Expects the view to be set up. Falls back to the whole window
+ * when the box crosses the eye plane.
+ */
+static void object_rect(const struct scene_object *obj, struct rect *r) {
+    GLdouble mv[16], proj[16];
+    GLint vp[4];
+    GLdouble minx = 1e30, miny = 1e30, maxx = -1e30, maxy = -1e30;
+    int i, k;
+
+    glPushMatrix();
+    apply_transform(obj);
+    glGetDoublev(GL_MODELVIEW_MATRIX, mv);
     glPopMatrix();
+    glGetDoublev(GL_PROJECTION_MATRIX, proj);
+    glGetIntegerv(GL_VIEWPORT, vp);
+
+    for (i = 0; i < 8; i++) {
+        GLdouble in[4], eye[4], clip[4];
+        in[0] = (i & 1) ? obj->radius : -obj->radius;
+        in[1] = (i & 2) ? obj->radius : -obj->radius;
+        in[2] = (i & 4) ? obj->radius : -obj->radius;
+        in[3] = 1.0;
+        for (k = 0; k < 4; k++) {
+            eye[k] = mv[k] * in[0] + mv[4 + k] * in[1] + mv[8 + k] * in[2] + mv[12 + k] * in[3];
+        }
+        for (k = 0; k < 4; k++) {
+            clip[k] = proj[k] * eye[0] + proj[4 + k] * eye[1] + proj[8 + k] * eye[2] + proj[12 + k] * eye[3];
+        }
+        if (clip[3] <= 0.0) {
+            r->x0 = vp[0];
+            r->y0 = vp[1];
+            r->x1 = vp[0] + vp[2];
+            r->y1 = vp[1] + vp[3];
+            return;
+        }
+        clip[0] = vp[0] + (clip[0] / clip[3] + 1.0) * 0.5 * vp[2];
+        clip[1] = vp[1] + (clip[1] / clip[3] + 1.0) * 0.5 * vp[3];
+        if (clip[0] < minx) minx = clip[0];
+        if (clip[0] > maxx) maxx = clip[0];
+        if (clip[1] < miny) miny = clip[1];
+        if (clip[1] > maxy) maxy = clip[1];
+    }
 
-    glDisable(GL_LIGHTING);
+    r->x0 = (GLint) floor(minx) - DIRTY_MARGIN;
+    r->y0 = (GLint) floor(miny) - DIRTY_MARGIN;
+    r->x1 = (GLint) ceil(maxx) + DIRTY_MARGIN;
+    r->y1 = (GLint) ceil(maxy) + DIRTY_MARGIN;
+    if (r->x0 < vp[0]) r->x0 = vp[0];
+    if (r->y0 < vp[1]) r->y0 = vp[1];
+    if (r->x1 > vp[0] + vp[2]) r->x1 = vp[0] + vp[2];
+    if (r->y1 > vp[1] + vp[3]) r->y1 = vp[1] + vp[3];
+}
+
+/**
+ * Draw the objects touching the dirty rectangle, clipped to it.
+ * Expects the view to be set up.
+ */
+static void render_image(const struct rect *dirty, const struct rect *rects) {
+    int i;
 
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(dirty->x0, dirty->y0, dirty->x1 - dirty->x0, dirty->y1 - dirty->y0);
+
+    glPushMatrix();
+    glLoadIdentity();
+    glLightfv(GL_LIGHT0, GL_AMBIENT, state.light_ambient);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, state.light_diffuse);
+    glLightfv(GL_LIGHT0, GL_SPECULAR, state.light_specular);
+    glLightfv(GL_LIGHT0, GL_POSITION, state.light_position);
+    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, state.light_model_ambient);
     glPopMatrix();
 
+    /* GL_LIGHT0 in eye space, as GL sees it after the identity load above */
+    memcpy(baked_light.model_ambient, state.light_model_ambient, sizeof(baked_light.model_ambient));
+    memcpy(baked_light.ambient, state.light_ambient, sizeof(baked_light.ambient));
+    memcpy(baked_light.diffuse, state.light_diffuse, sizeof(baked_light.diffuse));
+    memcpy(baked_light.position, state.light_position, sizeof(baked_light.position));
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHT0);
+
+    glClearColor(VIEW_CLEAR_COLOR);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    for (i = 0; i < num_objects; i++) {
+        const struct scene_object *obj = &objects[i];
+
+        if (!rect_overlaps(dirty, &rects[i])) {
+            continue;
+        }
+
+        if (obj->lit) {
+            glEnable(GL_LIGHTING);
+            glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, obj->material);
+        } else {
+            glDisable(GL_LIGHTING);
+            glColor4fv(obj->material);
+        }
+
+        glPushMatrix();
+        apply_transform(obj);
+        obj->draw(obj);
+        glPopMatrix();
+    }
+
+    glDisable(GL_LIGHTING);
     glDisable(GL_DEPTH_TEST);
 }
 
@@ -247,51 +439,257 @@ static void render_image(void) {
 static void init_context(void) {
     const GLint texWidth = 64, texHeight = 64;
     GLubyte *texImage;
-    int i, j;
 
     /* checker image */
     texImage = malloc(texWidth * texHeight * 4);
-    for (i = 0; i < texHeight; i++) {
-        for (j = 0; j < texWidth; j++) {
-            int k = (i * texWidth + j) * 4;
-            if ((i % 5) == 0 || (j % 5) == 0) {
-                texImage[k + 0] = 200;
-                texImage[k + 1] = 200;
-                texImage[k + 2] = 200;
-                texImage[k + 3] = 255;
-            } else {
-                if ((i % 5) == 1 || (j % 5) == 1) {
-                    texImage[k + 0] = 50;
-                    texImage[k + 1] = 50;
-                    texImage[k + 2] = 50;
-                    texImage[k + 3] = 255;
-                } else {
-                    texImage[k + 0] = 100;
-                    texImage[k + 1] = 100;
-                    texImage[k + 2] = 100;
-                    texImage[k + 3] = 255;
-                }
-            }
-        }
-    }
+    Checker(texImage, texWidth, texHeight);
 
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0,
                  GL_RGBA, GL_UNSIGNED_BYTE, texImage);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    state.texture_serial++;
 
     free(texImage);
 }
 
+/* drop the baked colors of the current objects, their caches stay usable */
+static void free_object_caches(void) {
+    int i;
+
+    for (i = 0; i < num_objects; i++) {
+        if (objects[i].cache) {
+            light_cache_free(objects[i].cache);
+        }
+    }
+}
+
+static int use_objects(struct scene_object *list, int count) {
+    free(drawn_objects);
+    free(drawn_rects);
+    free(frame_rects);
+    drawn_objects = malloc(count * sizeof(*drawn_objects));
+    drawn_rects = malloc(count * sizeof(*drawn_rects));
+    frame_rects = malloc(count * sizeof(*frame_rects));
+    if (!drawn_objects || !drawn_rects || !frame_rects) {
+        printf("out of memory for %d objects\n", count);
+        return 0;
+    }
+
+    free_object_caches();
+    objects = list;
+    num_objects = count;
+    drawn_valid = GL_FALSE;
+
+    return 1;
+}
+
+/**
+ * Use the objects of a binary scene file (see tools/scenec) instead of
+ * the built-in ones. Mesh and texel data are used in place.
+ */
+static int load_scene(const char *path) {
+    struct scene_object *list;
+    struct light_cache *caches;
+    uint64_t t0 = sceKernelGetProcessTimeWide();
+    uint32_t i, count;
+
+    if (!scene_load(&file_scene, path)) {
+        return 0;
+    }
+    scene_upload_textures(&file_scene);
+    state.texture_serial++;
+
+    count = file_scene.header->num_objects;
+    list = calloc(count, sizeof(*list));
+    caches = calloc(count, sizeof(*caches));
+    if (!list || !caches) {
+        free(list);
+        free(caches);
+        scene_free(&file_scene);
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        const struct scn_object *o = &file_scene.objects[i];
+        struct scene_object *obj = &list[i];
+
+        obj->draw = draw_mesh;
+        obj->mesh = &file_scene.meshes[o->mesh];
+        obj->mat = &file_scene.materials[o->material];
+        obj->texture = o->texture == SCN_NO_TEXTURE ? 0 : file_scene.texture_names[o->texture];
+        memcpy(obj->translate, o->translate, sizeof(obj->translate));
+        memcpy(obj->rotate, o->rotate, sizeof(obj->rotate));
+        memcpy(obj->material, obj->mat->color, sizeof(obj->material));
+        obj->radius = obj->mesh->radius;
+        obj->lit = (obj->mat->flags & SCN_LIT) != 0;
+        obj->cache = &caches[i];
+    }
+
+    if (!use_objects(list, count)) {
+        free(list);
+        free(caches);
+        scene_free(&file_scene);
+        return 0;
+    }
+
+    printf("%s: %u objects loaded in %.3f ms, %u bytes\n", path, (unsigned) count,
+           (sceKernelGetProcessTimeWide() - t0) / 1000.0, (unsigned) file_scene.size);
+
+    return 1;
+}
+
+/**
+ * Render the scene if any input changed since the last frame.
+ * Only the union of the old and new screen rectangles of moved objects
+ * is re-rendered; a full redraw happens when a global input (light, view,
+ * texture) changed. Returns GL_FALSE when the frame was skipped and the
+ * buffer still holds the current image.
+ */
 static GLboolean render_scene() {
+    struct rect *rects = frame_rects, dirty;
+    int i, full;
 
-    init_context();
-    render_image();
+    stats.frames++;
+
+    full = !drawn_valid || memcmp(&state, &drawn_state, sizeof(state)) != 0;
+
+    /* nothing changed, skip before projecting anything */
+    if (!full) {
+        for (i = 0; i < num_objects
+                    && memcmp(&objects[i], &drawn_objects[i], sizeof(objects[i])) == 0; i++) {
+        }
+        if (i == num_objects) {
+            stats.skipped++;
+            return GL_FALSE;
+        }
+    }
+
+    /* the view is part of the state, so unmoved objects keep their rects */
+    setup_view();
+    rect_clear(&dirty);
+    if (full) {
+        dirty.x1 = WIDTH;
+        dirty.y1 = HEIGHT;
+        for (i = 0; i < num_objects; i++) {
+            object_rect(&objects[i], &rects[i]);
+        }
+    } else {
+        for (i = 0; i < num_objects; i++) {
+            if (memcmp(&objects[i], &drawn_objects[i], sizeof(objects[i])) != 0) {
+                object_rect(&objects[i], &rects[i]);
+                rect_union(&dirty, &drawn_rects[i]);
+                rect_union(&dirty, &rects[i]);
+            } else {
+                rects[i] = drawn_rects[i];
+            }
+        }
+    }
+
+    memcpy(drawn_objects, objects, num_objects * sizeof(*objects));
+    memcpy(&drawn_state, &state, sizeof(state));
+    frame_rects = drawn_rects;
+    drawn_rects = rects;
+    drawn_valid = GL_TRUE;
+
+    if (rect_empty(&dirty)) {
+        stats.skipped++;
+        return GL_FALSE;
+    }
+
+    render_image(&dirty, rects);
     render_gradient();
+    glDisable(GL_SCISSOR_TEST);
 
-    return 1;
+    stats.pixels += (double) (dirty.x1 - dirty.x0) * (dirty.y1 - dirty.y0);
+
+    return GL_TRUE;
+}
+
+/* set to 1 to time live against baked lighting at startup */
+#ifndef COMPARE_LIGHTING
+#define COMPARE_LIGHTING 0
+#endif
+
+#if COMPARE_LIGHTING
+
+/**
+ * Time full redraws with GL_LIGHTING and with baked vertex colors.
+ * The baked run starts from empty caches, so it includes the one bake.
+ */
+static void compare_lighting(int frames) {
+    int pass, i;
+
+    for (i = 0; i < num_objects && !objects[i].cache; i++) {
+    }
+    if (i == num_objects) {
+        printf("baked lighting: no vertex arrays to bake\n");
+        return;
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        unsigned int hits = 0, misses = 0;
+        uint64_t t0;
+
+        baked_lighting = pass;
+        for (i = 0; i < num_objects; i++) {
+            if (objects[i].cache) {
+                light_cache_invalidate(objects[i].cache);
+                objects[i].cache->hits = objects[i].cache->misses = 0;
+            }
+        }
+
+        drawn_vertices = 0;
+        glFinish();
+        t0 = sceKernelGetProcessTimeWide();
+        for (i = 0; i < frames; i++) {
+            drawn_valid = GL_FALSE;
+            render_scene();
+        }
+        glFinish();
+        t0 = sceKernelGetProcessTimeWide() - t0;
+
+        for (i = 0; i < num_objects; i++) {
+            if (objects[i].cache) {
+                hits += objects[i].cache->hits;
+                misses += objects[i].cache->misses;
+            }
+        }
+        printf("%s lighting: %.3f ms/frame, %.2f Mverts/s, cache %u hits %u misses\n",
+               pass ? "baked" : "live", t0 / 1000.0 / frames,
+               t0 ? (double) drawn_vertices / t0 : 0.0, hits, misses);
+    }
+
+    baked_lighting = BAKED_LIGHTING;
+    drawn_valid = GL_FALSE;
+    stats.frames = stats.skipped = 0;
+    stats.pixels = 0.0;
 }
 
+#endif
+
+static void print_stats(void) {
+    printf("%u frames, %u skipped, %5.1f%% pixels re-rendered\n",
+           stats.frames, stats.skipped,
+           stats.frames ? 100.0 * stats.pixels / ((double) stats.frames * WIDTH * HEIGHT) : 0.0);
+    stats.frames = 0;
+    stats.skipped = 0;
+    stats.pixels = 0.0;
+}
+
+/* set to 1 to spin the cube and exercise partial re-rendering */
+#ifndef ANIMATE
+#define ANIMATE 0
+#endif
+
+static void animate(int frame) {
+#if ANIMATE
+    if (objects == builtin_objects) {
+        objects[OBJ_CUBE].rotate[0] = 40.0 + frame;
+    }
+#endif
+}
+
+
 static int gl_init(int w, int h) {
 
     const GLint z = 16, stencil = 0, accum = 0;
@@ -334,10 +732,7 @@ static int gl_init(int w, int h) {
     return 1;
 }
 
-static void gl_swap() {
-
-    /* Make sure buffered commands are finished! */
-    glFinish();
+static void gl_present() {
 
     vita2d_start_drawing();
     vita2d_clear_screen();
@@ -347,6 +742,14 @@ static void gl_swap() {
     vita2d_swap_buffers();
 }
 
+static void gl_swap() {
+
+    /* Make sure buffered commands are finished! */
+    glFinish();
+
+    gl_present();
+}
+
 static int gl_exit() {
 
     vita2d_wait_rendering_done();
@@ -361,15 +764,51 @@ static int gl_exit() {
 
 int main(int argc, char *argv[]) {
 
+    uint64_t launch = sceKernelGetProcessTimeWide();
+    int frame;
+
     psp2shell_init(3333, 5);
     printf("Hello, (GL)world!\n");
 
     gl_init(WIDTH, HEIGHT);
-    render_scene();
-    gl_swap();
+    init_context();
+    if (!load_scene("app0:scene.scn")) {
+#ifdef BAKED_MESHES
+        int i;
+        for (i = 0; i < NUM_BUILTIN_OBJECTS; i++) {
+            builtin_objects[i].cache = &builtin_caches[i];
+        }
+#endif
+        use_objects(builtin_objects, NUM_BUILTIN_OBJECTS);
+    }
+#if COMPARE_LIGHTING
+    compare_lighting(60);
+#endif
 
-    sceKernelDelayThread(100 * 1000000);
+    /* about 100 seconds, swap waits for vblank */
+    for (frame = 0; frame < 100 * 60; frame++) {
+        uint64_t t0 = sceKernelGetProcessTimeWide();
+        animate(frame);
+        if (render_scene()) {
+            if (frame == 0) {
+                glFinish();
+                printf("first frame in %.3f ms\n", (sceKernelGetProcessTimeWide() - t0) / 1000.0);
+            }
+            gl_swap();
+            if (frame == 0) {
+                printf("first frame presented %.3f ms after main()\n",
+                       (sceKernelGetProcessTimeWide() - launch) / 1000.0);
+            }
+        } else {
+            /* nothing changed, present the previous buffer again */
+            gl_present();
+        }
+        if ((frame + 1) % (5 * 60) == 0) {
+            print_stats();
+        }
+    }
 
+    free_object_caches();
     gl_exit();
 
     psp2shell_exit();
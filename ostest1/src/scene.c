@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef __vita__
+#include <sys/mman.h>
+#endif
+
+#include "scene.h"
+
+#ifdef __vita__
+#include <psp2shell.h>
+#define printf psp2shell_print
+#endif
+
+static int table_fits(const struct scene *scene, uint32_t offset, uint32_t count, size_t elem) {
+    return (offset & 3) == 0
+           && offset <= scene->size
+           && (uint64_t) count * elem <= scene->size - offset;
+}
+
+/* every index must name a vertex of its own mesh, glDrawElements doesn't check */
+static int indices_fit(const struct scene *scene, const struct scn_mesh *m) {
+    const uint16_t *idx = (const uint16_t *) (scene->base + m->indices);
+    uint32_t i;
+
+    for (i = 0; i < m->num_indices; i++) {
+        if (idx[i] >= m->num_vertices) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int scene_check(struct scene *scene) {
+    const struct scn_header *h = scene->header;
+    uint32_t i;
+
+    if (scene->size < sizeof(*h) || h->magic != SCN_MAGIC) {
+        printf("scene: bad magic\n");
+        return 0;
+    }
+    if (h->version != SCN_VERSION) {
+        printf("scene: version %u, expected %u\n", (unsigned) h->version, SCN_VERSION);
+        return 0;
+    }
+    if (h->size != scene->size
+        || !table_fits(scene, h->meshes, h->num_meshes, sizeof(struct scn_mesh))
+        || !table_fits(scene, h->materials, h->num_materials, sizeof(struct scn_material))
+        || !table_fits(scene, h->textures, h->num_textures, sizeof(struct scn_texture))
+        || !table_fits(scene, h->objects, h->num_objects, sizeof(struct scn_object))) {
+        printf("scene: truncated file\n");
+        return 0;
+    }
+
+    scene->meshes = (const struct scn_mesh *) (scene->base + h->meshes);
+    scene->materials = (const struct scn_material *) (scene->base + h->materials);
+    scene->textures = (const struct scn_texture *) (scene->base + h->textures);
+    scene->objects = (const struct scn_object *) (scene->base + h->objects);
+
+    for (i = 0; i < h->num_meshes; i++) {
+        const struct scn_mesh *m = &scene->meshes[i];
+        if ((m->mode != SCN_TRIANGLES && m->mode != SCN_QUADS)
+            || m->num_vertices > 65536
+            || !table_fits(scene, m->vertices, m->num_vertices, sizeof(struct scn_vertex))
+            || !table_fits(scene, m->indices, m->num_indices, sizeof(uint16_t))
+            || !indices_fit(scene, m)) {
+            printf("scene: bad mesh %u\n", (unsigned) i);
+            return 0;
+        }
+    }
+    for (i = 0; i < h->num_textures; i++) {
+        const struct scn_texture *t = &scene->textures[i];
+        if (t->width > 4096 || t->height > 4096
+            || (t->filter != SCN_NEAREST && t->filter != SCN_LINEAR)
+            || !table_fits(scene, t->texels, t->width * t->height, 4)) {
+            printf("scene: bad texture %u\n", (unsigned) i);
+            return 0;
+        }
+    }
+    for (i = 0; i < h->num_objects; i++) {
+        const struct scn_object *o = &scene->objects[i];
+        if (o->mesh >= h->num_meshes || o->material >= h->num_materials
+            || (o->texture != SCN_NO_TEXTURE && o->texture >= h->num_textures)) {
+            printf("scene: bad object %u\n", (unsigned) i);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int scene_load(struct scene *scene, const char *path) {
+    struct stat st;
+    int fd;
+
+    memset(scene, 0, sizeof(*scene));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    scene->size = (size_t) st.st_size;
+
+#ifndef __vita__
+    {
+        void *p = mmap(NULL, scene->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            scene->base = p;
+            scene->mapped = 1;
+        }
+    }
+#endif
+    if (!scene->base) {
+        /* no file mapping here, a single read into one block does the same job */
+        unsigned char *p = malloc(scene->size);
+        size_t done = 0;
+        while (p && done < scene->size) {
+            ssize_t n = read(fd, p + done, scene->size - done);
+            if (n <= 0) {
+                free(p);
+                p = NULL;
+                break;
+            }
+            done += (size_t) n;
+        }
+        scene->base = p;
+    }
+    close(fd);
+
+    if (!scene->base) {
+        printf("scene: can't read %s\n", path);
+        return 0;
+    }
+
+    scene->header = (const struct scn_header *) scene->base;
+    if (!scene_check(scene)) {
+        scene_free(scene);
+        return 0;
+    }
+
+    return 1;
+}
+
+void scene_upload_textures(struct scene *scene) {
+    uint32_t i, n = scene->header->num_textures;
+
+    if (n == 0) {
+        return;
+    }
+
+    scene->texture_names = malloc(n * sizeof(GLuint));
+    glGenTextures(n, scene->texture_names);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (i = 0; i < n; i++) {
+        const struct scn_texture *t = &scene->textures[i];
+        glBindTexture(GL_TEXTURE_2D, scene->texture_names[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t->width, t->height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, scene->base + t->texels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, t->filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, t->filter);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void scene_draw_mesh(const struct scene *scene, const struct scn_mesh *mesh, const GLubyte *colors) {
+    const struct scn_vertex *v = (const struct scn_vertex *) (scene->base + mesh->vertices);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(*v), v->position);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(*v), v->texcoord);
+    if (colors) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+    } else {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, sizeof(*v), v->normal);
+    }
+
+    glDrawElements(mesh->mode, mesh->num_indices, GL_UNSIGNED_SHORT, scene->base + mesh->indices);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void scene_draw_material_mesh(const struct scene *scene, const struct scn_mesh *mesh,
+                              const struct scn_material *mat, GLuint texture, const GLubyte *colors) {
+    if (texture) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glEnable(GL_TEXTURE_2D);
+    }
+    if (mat->flags & SCN_WIREFRAME) {
+        glLineWidth(mat->line_width);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    }
+    if (mat->flags & SCN_BLEND) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_BLEND);
+    }
+    if (mat->flags & SCN_CULL) {
+        glEnable(GL_CULL_FACE);
+    }
+
+    scene_draw_mesh(scene, mesh, colors);
+
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    if (texture) {
+        glDisable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+void scene_free_textures(struct scene *scene) {
+    if (scene->texture_names) {
+        glDeleteTextures(scene->header->num_textures, scene->texture_names);
+        free(scene->texture_names);
+        scene->texture_names = NULL;
+    }
+}
+
+void scene_free(struct scene *scene) {
+    scene_free_textures(scene);
+    if (scene->base) {
+#ifndef __vita__
+        if (scene->mapped) {
+            munmap((void *) scene->base, scene->size);
+        } else
+#endif
+        free((void *) scene->base);
+    }
+    memset(scene, 0, sizeof(*scene));
+}
@@ -0,0 +1,51 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stddef.h>
+#include <GL/gl.h>
+
+#include "scene_format.h"
+
+struct scene {
+    const unsigned char *base;
+    size_t size;
+    int mapped;                 /* base comes from mmap, otherwise malloc */
+    const struct scn_header *header;
+    const struct scn_mesh *meshes;
+    const struct scn_material *materials;
+    const struct scn_texture *textures;
+    const struct scn_object *objects;
+    GLuint *texture_names;
+};
+
+/**
+ * Map a scene file and check its tables fit the file.
+ * Nothing is parsed or copied. Returns 1 on success, 0 on failure.
+ */
+int scene_load(struct scene *scene, const char *path);
+
+/**
+ * Create a texture object for each scene texture, straight from the
+ * mapped texels. Needs a current context.
+ */
+void scene_upload_textures(struct scene *scene);
+
+/**
+ * Draw a mesh from its vertex arrays. With colors (RGBA bytes, one per
+ * vertex) the normals are left out and the colors are used instead.
+ */
+void scene_draw_mesh(const struct scene *scene, const struct scn_mesh *mesh, const GLubyte *colors);
+
+/**
+ * Draw a mesh with the state its material asks for: texture, wireframe,
+ * blending and culling. Lighting and the transform are up to the caller.
+ */
+void scene_draw_material_mesh(const struct scene *scene, const struct scn_mesh *mesh,
+                              const struct scn_material *mat, GLuint texture, const GLubyte *colors);
+
+/* delete the texture objects, the file stays loaded */
+void scene_free_textures(struct scene *scene);
+
+void scene_free(struct scene *scene);
+
+#endif /* SCENE_H */
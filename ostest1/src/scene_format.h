@@ -0,0 +1,93 @@
+#ifndef SCENE_FORMAT_H
+#define SCENE_FORMAT_H
+
+#include <stdint.h>
+
+/**
+ * Binary scene file layout, shared by the loader and tools/scenec.
+ *
+ * The file is little endian and laid out so it can be used in place:
+ * every table is 4 byte aligned and referenced by its offset from the
+ * start of the file. Vertex and index arrays go straight to
+ * glVertexPointer/glDrawElements, texel arrays to glTexImage2D.
+ *
+ *   scn_header
+ *   scn_mesh[num_meshes]
+ *   scn_material[num_materials]
+ *   scn_texture[num_textures]
+ *   scn_object[num_objects]
+ *   vertex, index and texel data
+ */
+
+#define SCN_MAGIC   0x4e435353  /* "SSCN" */
+#define SCN_VERSION 1
+
+/* mesh primitive modes, same values as the GL enums */
+#define SCN_TRIANGLES 0x0004
+#define SCN_QUADS     0x0007
+
+/* material flags */
+#define SCN_LIT       0x01
+#define SCN_WIREFRAME 0x02
+#define SCN_BLEND     0x04
+#define SCN_CULL      0x08
+
+/* texture filters, same values as the GL enums */
+#define SCN_NEAREST 0x2600
+#define SCN_LINEAR  0x2601
+
+/* object without texture */
+#define SCN_NO_TEXTURE 0xffffffff
+
+struct scn_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              /* whole file, in bytes */
+    uint32_t num_meshes;
+    uint32_t meshes;
+    uint32_t num_materials;
+    uint32_t materials;
+    uint32_t num_textures;
+    uint32_t textures;
+    uint32_t num_objects;
+    uint32_t objects;
+};
+
+/* interleaved, 32 bytes */
+struct scn_vertex {
+    float position[3];
+    float normal[3];
+    float texcoord[2];
+};
+
+struct scn_mesh {
+    uint32_t mode;
+    uint32_t num_vertices;
+    uint32_t vertices;          /* scn_vertex[num_vertices] */
+    uint32_t num_indices;
+    uint32_t indices;           /* uint16_t[num_indices], padded to 4 bytes */
+    float radius;               /* bounding radius around the origin */
+};
+
+struct scn_material {
+    float color[4];             /* ambient and diffuse, or color when unlit */
+    float line_width;
+    uint32_t flags;
+};
+
+struct scn_texture {
+    uint32_t width;
+    uint32_t height;
+    uint32_t filter;
+    uint32_t texels;            /* RGBA8, width * height * 4 bytes */
+};
+
+struct scn_object {
+    uint32_t mesh;
+    uint32_t material;
+    uint32_t texture;           /* index or SCN_NO_TEXTURE */
+    float translate[3];
+    float rotate[4];            /* angle, x, y, z */
+};
+
+#endif /* SCENE_FORMAT_H */
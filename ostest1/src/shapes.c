@@ -0,0 +1,96 @@
+#include <math.h>
+#include <GL/gl.h>
+
+#include "shapes.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265
+#endif
+
+void Torus(float innerRadius, float outerRadius, int sides, int rings) {
+    /* from GLUT... */
+    int i, j;
+    GLfloat theta, phi, theta1;
+    GLfloat cosTheta, sinTheta;
+    GLfloat cosTheta1, sinTheta1;
+    const GLfloat ringDelta = 2.0 * M_PI / rings;
+    const GLfloat sideDelta = 2.0 * M_PI / sides;
+
+    theta = 0.0;
+    cosTheta = 1.0;
+    sinTheta = 0.0;
+    for (i = rings - 1; i >= 0; i--) {
+        theta1 = theta + ringDelta;
+        cosTheta1 = cos(theta1);
+        sinTheta1 = sin(theta1);
+        glBegin(GL_QUAD_STRIP);
+        phi = 0.0;
+        for (j = sides; j >= 0; j--) {
+            GLfloat cosPhi, sinPhi, dist;
+
+            phi += sideDelta;
+            cosPhi = cos(phi);
+            sinPhi = sin(phi);
+            dist = outerRadius + innerRadius * cosPhi;
+
+            glNormal3f(cosTheta1 * cosPhi, -sinTheta1 * cosPhi, sinPhi);
+            glVertex3f(cosTheta1 * dist, -sinTheta1 * dist, innerRadius * sinPhi);
+            glNormal3f(cosTheta * cosPhi, -sinTheta * cosPhi, sinPhi);
+            glVertex3f(cosTheta * dist, -sinTheta * dist, innerRadius * sinPhi);
+        }
+        glEnd();
+        theta = theta1;
+        cosTheta = cosTheta1;
+        sinTheta = sinTheta1;
+    }
+}
+
+
+void Cube(float size) {
+    size = 0.5 * size;
+
+    glBegin(GL_QUADS);
+    /* +X face */
+    glNormal3f(1, 0, 0);
+    glVertex3f(size, -size, size);
+    glVertex3f(size, -size, -size);
+    glVertex3f(size, size, -size);
+    glVertex3f(size, size, size);
+
+    /* -X face */
+    glNormal3f(-1, 0, 0);
+    glVertex3f(-size, size, size);
+    glVertex3f(-size, size, -size);
+    glVertex3f(-size, -size, -size);
+    glVertex3f(-size, -size, size);
+
+    /* +Y face */
+    glNormal3f(0, 1, 0);
+    glVertex3f(-size, size, size);
+    glVertex3f(size, size, size);
+    glVertex3f(size, size, -size);
+    glVertex3f(-size, size, -size);
+
+    /* -Y face */
+    glNormal3f(0, -1, 0);
+    glVertex3f(-size, -size, -size);
+    glVertex3f(size, -size, -size);
+    glVertex3f(size, -size, size);
+    glVertex3f(-size, -size, size);
+
+    /* +Z face */
+    glNormal3f(0, 0, 1);
+    glVertex3f(-size, -size, size);
+    glVertex3f(size, -size, size);
+    glVertex3f(size, size, size);
+    glVertex3f(-size, size, size);
+
+    /* -Z face */
+    glNormal3f(0, 0, -1);
+    glVertex3f(-size, size, -size);
+    glVertex3f(size, size, -size);
+    glVertex3f(size, -size, -size);
+    glVertex3f(-size, -size, -size);
+
+    glEnd();
+}
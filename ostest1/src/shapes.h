@@ -0,0 +1,8 @@
+#ifndef SHAPES_H
+#define SHAPES_H
+
+void Torus(float innerRadius, float outerRadius, int sides, int rings);
+
+void Cube(float size);
+
+#endif /* SHAPES_H */
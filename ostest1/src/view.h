@@ -0,0 +1,27 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+/**
+ * Light and camera of the ostest1 scene, shared by ostest1 and the farm
+ * so both draw the scene file the same. Initializers, so they can fill
+ * ostest1's animated state as well as constant arrays.
+ */
+
+/* GL_LIGHT0 */
+#define VIEW_LIGHT_AMBIENT  {0.0, 0.0, 0.0, 1.0}
+#define VIEW_LIGHT_DIFFUSE  {1.0, 1.0, 1.0, 1.0}
+#define VIEW_LIGHT_SPECULAR {1.0, 1.0, 1.0, 1.0}
+#define VIEW_LIGHT_POSITION {1.0, 1.0, 1.0, 0.0}
+
+/* GL_LIGHT_MODEL_AMBIENT, GL's default */
+#define VIEW_MODEL_AMBIENT  {0.2, 0.2, 0.2, 1.0}
+
+/* camera, a translation then a rotation around x, in degrees */
+#define VIEW_TRANSLATE      {0.0, 0.5, -7.0}
+#define VIEW_ROTX           20.0
+
+/* glFrustum and glClearColor arguments */
+#define VIEW_FRUSTUM        -1.0, 1.0, -1.0, 1.0, 2.0, 50.0
+#define VIEW_CLEAR_COLOR    0.3, 0.3, 0.7, 0.0
+
+#endif /* VIEW_H */
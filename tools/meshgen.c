@@ -0,0 +1,168 @@
+/**
+ * meshgen - bake the sample meshes into C arrays at build time.
+ *
+ *   meshgen gears|ostest1 output.h
+ *
+ * The meshes come from the recorder (see recorder.h), so the baked
+ * vertices are exactly what the runtime path would send.
+ *
+ * The output defines a struct baked_mesh per mesh and draw_baked_mesh(),
+ * which draws one with glDrawArrays, one call per glBegin/glEnd pair of
+ * the original code.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/gl.h>
+
+#include "gear.h"
+#include "recorder.h"
+#include "shapes.h"
+
+static const char *mode_name(GLenum mode) {
+    switch (mode) {
+        case GL_QUADS:
+            return "GL_QUADS";
+        case GL_QUAD_STRIP:
+            return "GL_QUAD_STRIP";
+        case GL_TRIANGLE_FAN:
+            return "GL_TRIANGLE_FAN";
+        case GL_POLYGON:
+            return "GL_POLYGON";
+        default:
+            fprintf(stderr, "unexpected primitive 0x%x\n", mode);
+            exit(1);
+    }
+}
+
+static const char *shade_name(GLenum mode) {
+    return mode == GL_FLAT ? "GL_FLAT" : mode == GL_SMOOTH ? "GL_SMOOTH" : "0";
+}
+
+/* float literal that reads back as the same value */
+static void put_float(FILE *f, GLfloat x) {
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "%.9g", x);
+    if (!strpbrk(buf, ".en")) {
+        strcat(buf, ".0");
+    }
+    fprintf(f, "%sf", buf);
+}
+
+static void write_mesh(FILE *f, const char *name) {
+    int i, k;
+
+    fprintf(f, "static const GLfloat %s_vertices[] = {\n", name);
+    for (i = 0; i < rec.num_vertices; i++) {
+        fprintf(f, "       ");
+        for (k = 0; k < 6; k++) {
+            fprintf(f, " ");
+            put_float(f, rec.vertices[i * 6 + k]);
+            fprintf(f, ",");
+        }
+        fprintf(f, "\n");
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "static const struct baked_batch %s_batches[] = {\n", name);
+    for (i = 0; i < rec.num_batches; i++) {
+        fprintf(f, "        {%s, %s, %d, %d},\n", mode_name(rec.batches[i].mode),
+                shade_name(rec.batches[i].shade_model), rec.batches[i].first, rec.batches[i].count);
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "static const struct baked_mesh baked_%s = {\n"
+               "        %s_vertices, %d, %s_batches, %d\n"
+               "};\n\n", name, name, rec.num_vertices, name, rec.num_batches);
+}
+
+int main(int argc, char *argv[]) {
+    FILE *f;
+
+    if (argc != 3 || (strcmp(argv[1], "gears") != 0 && strcmp(argv[1], "ostest1") != 0)) {
+        fprintf(stderr, "usage: %s gears|ostest1 output.h\n", argv[0]);
+        return 1;
+    }
+
+    f = fopen(argv[2], "w");
+    if (!f) {
+        fprintf(stderr, "can't write %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(f, "/* generated by tools/meshgen, do not edit */\n"
+               "#ifndef BAKED_MESHES_H\n"
+               "#define BAKED_MESHES_H\n\n"
+               "struct baked_batch {\n"
+               "    GLenum mode;\n"
+               "    GLenum shade_model;     /* 0 to leave it alone */\n"
+               "    GLint first;\n"
+               "    GLsizei count;\n"
+               "};\n\n"
+               "struct baked_mesh {\n"
+               "    const GLfloat *vertices;  /* x y z nx ny nz */\n"
+               "    GLsizei num_vertices;\n"
+               "    const struct baked_batch *batches;\n"
+               "    int num_batches;\n"
+               "};\n\n"
+               "/* one glDrawArrays per batch, lit by GL from the normals or, with\n"
+               "   colors, by one RGBA color per vertex */\n"
+               "static void draw_baked_mesh(const struct baked_mesh *mesh, const GLubyte *colors) {\n"
+               "    int i;\n\n"
+               "    glEnableClientState(GL_VERTEX_ARRAY);\n"
+               "    glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), mesh->vertices);\n"
+               "    if (colors) {\n"
+               "        glEnableClientState(GL_COLOR_ARRAY);\n"
+               "        glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);\n"
+               "    } else {\n"
+               "        glEnableClientState(GL_NORMAL_ARRAY);\n"
+               "        glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat), mesh->vertices + 3);\n"
+               "    }\n\n"
+               "    for (i = 0; i < mesh->num_batches; i++) {\n"
+               "        const struct baked_batch *b = &mesh->batches[i];\n"
+               "        if (b->shade_model) {\n"
+               "            glShadeModel(b->shade_model);\n"
+               "        }\n"
+               "        glDrawArrays(b->mode, b->first, b->count);\n"
+               "    }\n\n"
+               "    glDisableClientState(GL_VERTEX_ARRAY);\n"
+               "    glDisableClientState(GL_NORMAL_ARRAY);\n"
+               "    glDisableClientState(GL_COLOR_ARRAY);\n"
+               "}\n\n");
+
+    /* same parameters as the samples */
+    if (strcmp(argv[1], "gears") == 0) {
+        rec_reset();
+        gear(1.0, 4.0, 1.0, 20, 0.7);
+        write_mesh(f, "gear1");
+        rec_reset();
+        gear(0.5, 2.0, 2.0, 10, 0.7);
+        write_mesh(f, "gear2");
+        rec_reset();
+        gear(1.3, 2.0, 0.5, 10, 0.7);
+        write_mesh(f, "gear3");
+    } else {
+        rec_reset();
+        Torus(0.275, 0.85, 20, 20);
+        write_mesh(f, "torus");
+        rec_reset();
+        cylinder(1.0, 0.0, 2.0, 16, 1);
+        write_mesh(f, "cone");
+        rec_reset();
+        sphere(1.2, 20, 20);
+        write_mesh(f, "sphere");
+        rec_reset();
+        Cube(1.0);
+        write_mesh(f, "cube");
+    }
+
+    fprintf(f, "#endif /* BAKED_MESHES_H */\n");
+
+    if (fclose(f) != 0) {
+        fprintf(stderr, "can't write %s\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
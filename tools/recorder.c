@@ -0,0 +1,170 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "recorder.h"
+
+struct recording rec;
+
+static int alloc_vertices, alloc_batches;
+static GLfloat normal[3] = {0.0, 0.0, 1.0};
+static GLenum shade_model;
+
+static void *must_realloc(void *p, size_t size) {
+    p = realloc(p, size);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+void rec_reset(void) {
+    rec.num_vertices = 0;
+    rec.num_batches = 0;
+    normal[0] = 0.0;
+    normal[1] = 0.0;
+    normal[2] = 1.0;
+    shade_model = 0;
+}
+
+static void rec_begin(GLenum mode) {
+    struct rec_batch *b;
+
+    if (rec.num_batches == alloc_batches) {
+        alloc_batches = alloc_batches ? alloc_batches * 2 : 16;
+        rec.batches = must_realloc(rec.batches, alloc_batches * sizeof(*rec.batches));
+    }
+    b = &rec.batches[rec.num_batches++];
+    b->mode = mode;
+    b->shade_model = shade_model;
+    b->first = rec.num_vertices;
+    b->count = 0;
+}
+
+static void rec_end(void) {
+    rec.batches[rec.num_batches - 1].count = rec.num_vertices - rec.batches[rec.num_batches - 1].first;
+}
+
+static void rec_normal3f(GLfloat x, GLfloat y, GLfloat z) {
+    normal[0] = x;
+    normal[1] = y;
+    normal[2] = z;
+}
+
+static void rec_vertex3f(GLfloat x, GLfloat y, GLfloat z) {
+    GLfloat *v;
+
+    if (rec.num_vertices == alloc_vertices) {
+        alloc_vertices = alloc_vertices ? alloc_vertices * 2 : 256;
+        rec.vertices = must_realloc(rec.vertices, alloc_vertices * 6 * sizeof(*rec.vertices));
+    }
+    v = &rec.vertices[rec.num_vertices++ * 6];
+    v[0] = x;
+    v[1] = y;
+    v[2] = z;
+    v[3] = normal[0];
+    v[4] = normal[1];
+    v[5] = normal[2];
+}
+
+static void rec_shade_model(GLenum mode) {
+    shade_model = mode;
+}
+
+#define glBegin rec_begin
+#define glEnd rec_end
+#define glNormal3f rec_normal3f
+#define glVertex3f rec_vertex3f
+#define glShadeModel rec_shade_model
+
+#include "gear.c"
+#include "shapes.c"
+
+/* GLU normalizes its normals */
+static void normal3f(GLfloat x, GLfloat y, GLfloat z) {
+    GLfloat mag = sqrt(x * x + y * y + z * z);
+    if (mag > 0.00001) {
+        x /= mag;
+        y /= mag;
+        z /= mag;
+    }
+    glNormal3f(x, y, z);
+}
+
+void cylinder(GLfloat base, GLfloat top, GLfloat height, int slices, int stacks) {
+    GLfloat da = 2.0 * M_PI / slices;
+    GLfloat dr = (top - base) / stacks;
+    GLfloat dz = height / stacks;
+    GLfloat nz = (base - top) / height;
+    GLfloat r = base, z = 0.0;
+    int i, j;
+
+    for (j = 0; j < stacks; j++) {
+        glBegin(GL_QUAD_STRIP);
+        for (i = 0; i <= slices; i++) {
+            GLfloat x = (i == slices) ? sin(0.0) : sin(i * da);
+            GLfloat y = (i == slices) ? cos(0.0) : cos(i * da);
+            normal3f(x, y, nz);
+            glVertex3f(x * r, y * r, z);
+            normal3f(x, y, nz);
+            glVertex3f(x * (r + dr), y * (r + dr), z + dz);
+        }
+        glEnd();
+        r += dr;
+        z += dz;
+    }
+}
+
+void sphere(GLfloat radius, int slices, int stacks) {
+    GLfloat drho = M_PI / stacks;
+    GLfloat dtheta = 2.0 * M_PI / slices;
+    GLfloat x, y, z, rho, theta;
+    int i, j;
+
+    glBegin(GL_TRIANGLE_FAN);
+    glNormal3f(0.0, 0.0, 1.0);
+    glVertex3f(0.0, 0.0, radius);
+    for (j = 0; j <= slices; j++) {
+        theta = (j == slices) ? 0.0 : j * dtheta;
+        x = -sin(theta) * sin(drho);
+        y = cos(theta) * sin(drho);
+        z = cos(drho);
+        glNormal3f(x, y, z);
+        glVertex3f(x * radius, y * radius, z * radius);
+    }
+    glEnd();
+
+    for (i = 1; i < stacks - 1; i++) {
+        rho = i * drho;
+        glBegin(GL_QUAD_STRIP);
+        for (j = 0; j <= slices; j++) {
+            theta = (j == slices) ? 0.0 : j * dtheta;
+            x = -sin(theta) * sin(rho);
+            y = cos(theta) * sin(rho);
+            z = cos(rho);
+            glNormal3f(x, y, z);
+            glVertex3f(x * radius, y * radius, z * radius);
+            x = -sin(theta) * sin(rho + drho);
+            y = cos(theta) * sin(rho + drho);
+            z = cos(rho + drho);
+            glNormal3f(x, y, z);
+            glVertex3f(x * radius, y * radius, z * radius);
+        }
+        glEnd();
+    }
+
+    glBegin(GL_TRIANGLE_FAN);
+    glNormal3f(0.0, 0.0, -1.0);
+    glVertex3f(0.0, 0.0, -radius);
+    rho = M_PI - drho;
+    for (j = slices; j >= 0; j--) {
+        theta = (j == slices) ? 0.0 : j * dtheta;
+        x = -sin(theta) * sin(rho);
+        y = cos(theta) * sin(rho);
+        z = cos(rho);
+        glNormal3f(x, y, z);
+        glVertex3f(x * radius, y * radius, z * radius);
+    }
+    glEnd();
+}
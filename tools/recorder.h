@@ -0,0 +1,40 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <GL/gl.h>
+
+/**
+ * Records the immediate mode calls of the sample mesh code on the host,
+ * so the host tools get exactly the vertices the runtime path would send.
+ * gear(), Torus() and Cube() (see gear.h and shapes.h) are compiled into
+ * the recorder, cylinder() and sphere() tessellate like gluCylinder and
+ * gluSphere.
+ */
+
+/* one glBegin/glEnd pair */
+struct rec_batch {
+    GLenum mode;
+    GLenum shade_model;         /* 0 when the code did not set one */
+    int first;
+    int count;
+};
+
+struct recording {
+    GLfloat *vertices;          /* x y z nx ny nz */
+    int num_vertices;
+    struct rec_batch *batches;
+    int num_batches;
+};
+
+/* what was recorded since the last rec_reset() */
+extern struct recording rec;
+
+void rec_reset(void);
+
+/* gluCylinder, GLU_FILL and GLU_SMOOTH */
+void cylinder(GLfloat base, GLfloat top, GLfloat height, int slices, int stacks);
+
+/* gluSphere, GLU_FILL and GLU_SMOOTH without texture coordinates */
+void sphere(GLfloat radius, int slices, int stacks);
+
+#endif /* RECORDER_H */
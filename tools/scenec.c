@@ -0,0 +1,595 @@
+/**
+ * scenec - convert a text scene description to the binary scene format
+ * read by ostest1 (see ostest1/src/scene_format.h).
+ *
+ *   scenec [-r copies] input.txt output.scn
+ *
+ * -r repeats the object list on a grid, to build large test scenes.
+ *
+ * Input, one statement per line, '#' starts a comment:
+ *
+ *   texture <name> checker <width> <height> [linear]
+ *   texture <name> raw <width> <height> <file> [linear]   RGBA8 texels
+ *   material <name> <r> <g> <b> <a> [lit] [wireframe] [blend] [cull]
+ *            [line <width>]
+ *   mesh <name> torus <inner> <outer> <sides> <rings>
+ *   mesh <name> cone <base> <height> <slices> <stacks>
+ *   mesh <name> sphere <radius> <slices> <stacks>
+ *   mesh <name> cube <size>
+ *   mesh <name> quads|triangles
+ *     v <x> <y> <z> <nx> <ny> <nz> <s> <t>
+ *     i <index> ...
+ *   end
+ *   object <mesh> <material> <texture|-> <tx> <ty> <tz> [<angle> <x> <y> <z>]
+ *
+ * The procedural meshes are recorded from the code ostest1 draws them
+ * with (see recorder.h), so both give the same vertices.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checker.h"
+#include "recorder.h"
+#include "scene_format.h"
+#include "shapes.h"
+
+#define MAX_NAME 32
+#define MAX_LINE 1024
+
+struct buffer {
+    unsigned char *data;
+    size_t size, alloc;
+};
+
+struct named {
+    char name[MAX_NAME];
+};
+
+struct mesh_build {
+    struct scn_mesh mesh;
+    struct scn_vertex *vertices;
+    uint16_t *indices;
+    uint32_t alloc_vertices, alloc_indices;
+};
+
+struct texture_build {
+    struct scn_texture texture;
+    unsigned char *texels;
+};
+
+static struct named *mesh_names, *material_names, *texture_names;
+static struct mesh_build *meshes;
+static struct scn_material *materials;
+static struct texture_build *textures;
+static struct scn_object *objects;
+static uint32_t num_meshes, num_materials, num_textures, num_objects;
+
+static const char *input_name;
+static int line_no;
+
+static void die(const char *msg) {
+    fprintf(stderr, "%s:%d: %s\n", input_name, line_no, msg);
+    exit(1);
+}
+
+static void *grow(void *p, uint32_t count, size_t elem) {
+    /* grow by doubling whenever count reaches a power of two */
+    if (count == 0 || (count & (count - 1)) == 0) {
+        p = realloc(p, (count ? count * 2 : 1) * elem);
+        if (!p) {
+            die("out of memory");
+        }
+    }
+    return p;
+}
+
+static uint32_t find(const struct named *names, uint32_t count, const char *name) {
+    uint32_t i;
+    for (i = 0; i < count; i++) {
+        if (strcmp(names[i].name, name) == 0) {
+            return i;
+        }
+    }
+    die("unknown name");
+    return 0;
+}
+
+static void set_name(struct named *n, const char *name) {
+    if (strlen(name) >= MAX_NAME) {
+        die("name too long");
+    }
+    strcpy(n->name, name);
+}
+
+static void add_vertex(struct mesh_build *b, float x, float y, float z,
+                       float nx, float ny, float nz, float s, float t) {
+    struct scn_vertex *v;
+
+    if (b->mesh.num_vertices >= 65536) {
+        die("too many vertices in mesh");
+    }
+    if (b->mesh.num_vertices == b->alloc_vertices) {
+        b->alloc_vertices = b->alloc_vertices ? b->alloc_vertices * 2 : 64;
+        b->vertices = realloc(b->vertices, b->alloc_vertices * sizeof(*b->vertices));
+        if (!b->vertices) {
+            die("out of memory");
+        }
+    }
+    v = &b->vertices[b->mesh.num_vertices++];
+    v->position[0] = x;
+    v->position[1] = y;
+    v->position[2] = z;
+    v->normal[0] = nx;
+    v->normal[1] = ny;
+    v->normal[2] = nz;
+    v->texcoord[0] = s;
+    v->texcoord[1] = t;
+}
+
+static void add_index(struct mesh_build *b, long index) {
+    if (index < 0 || index > 65535) {
+        die("bad index");
+    }
+    if (b->mesh.num_indices == b->alloc_indices) {
+        b->alloc_indices = b->alloc_indices ? b->alloc_indices * 2 : 64;
+        b->indices = realloc(b->indices, b->alloc_indices * sizeof(*b->indices));
+        if (!b->indices) {
+            die("out of memory");
+        }
+    }
+    b->indices[b->mesh.num_indices++] = (uint16_t) index;
+}
+
+/* adds a vertex unless an identical one is already in the mesh, returns its index */
+static uint32_t add_shared_vertex(struct mesh_build *b, uint32_t *table, uint32_t mask,
+                                  const GLfloat *v) {
+    struct scn_vertex key;
+    uint32_t h = 2166136261u, i;
+    const unsigned char *p = (const unsigned char *) &key;
+
+    memset(&key, 0, sizeof(key));
+    memcpy(key.position, v, sizeof(key.position));
+    memcpy(key.normal, v + 3, sizeof(key.normal));
+    for (i = 0; i < sizeof(key); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    for (i = h & mask; table[i] != UINT32_MAX; i = (i + 1) & mask) {
+        if (memcmp(&b->vertices[table[i]], &key, sizeof(key)) == 0) {
+            return table[i];
+        }
+    }
+    table[i] = b->mesh.num_vertices;
+    add_vertex(b, v[0], v[1], v[2], v[3], v[4], v[5], 0, 0);
+    return table[i];
+}
+
+/**
+ * Meshes are quads, so wireframes show the edges of the original primitives.
+ * A triangle is a quad repeating its last vertex, which fills and outlines
+ * the same.
+ */
+static void add_face(struct mesh_build *b, const uint32_t *v, int n) {
+    add_index(b, v[0]);
+    add_index(b, v[1]);
+    add_index(b, v[2]);
+    add_index(b, v[n - 1]);
+}
+
+/**
+ * Turn what the recorder captured into an indexed mesh. Identical vertices
+ * are shared, faces keep the winding of the original primitives.
+ */
+static void build_recorded(struct mesh_build *b) {
+    uint32_t *table, mask, f[4];
+    int i, k;
+
+    for (mask = 1; mask < (uint32_t) rec.num_vertices * 2; mask <<= 1) {
+    }
+    table = malloc(mask * sizeof(*table));
+    if (!table) {
+        die("out of memory");
+    }
+    memset(table, 0xff, mask * sizeof(*table));
+    mask--;
+
+#define V(k) add_shared_vertex(b, table, mask, &rec.vertices[(first + (k)) * 6])
+    for (i = 0; i < rec.num_batches; i++) {
+        int first = rec.batches[i].first, count = rec.batches[i].count;
+
+        switch (rec.batches[i].mode) {
+            case GL_QUADS:
+                for (k = 0; k + 3 < count; k += 4) {
+                    f[0] = V(k);
+                    f[1] = V(k + 1);
+                    f[2] = V(k + 2);
+                    f[3] = V(k + 3);
+                    add_face(b, f, 4);
+                }
+                break;
+            case GL_QUAD_STRIP:
+                for (k = 0; k + 3 < count; k += 2) {
+                    f[0] = V(k);
+                    f[1] = V(k + 1);
+                    f[2] = V(k + 3);
+                    f[3] = V(k + 2);
+                    add_face(b, f, 4);
+                }
+                break;
+            case GL_TRIANGLE_FAN:
+            case GL_POLYGON:
+                for (k = 1; k + 1 < count; k++) {
+                    f[0] = V(0);
+                    f[1] = V(k);
+                    f[2] = V(k + 1);
+                    add_face(b, f, 3);
+                }
+                break;
+            default:
+                die("unexpected primitive");
+        }
+    }
+#undef V
+
+    free(table);
+}
+
+static void finish_mesh(struct mesh_build *b) {
+    uint32_t i;
+    float radius = 0;
+
+    /* same checks as the loader, so a bad mesh fails here and not on the device */
+    for (i = 0; i < b->mesh.num_indices; i++) {
+        if (b->indices[i] >= b->mesh.num_vertices) {
+            die("index out of range");
+        }
+    }
+
+    if (b->mesh.radius > 0) {
+        return;
+    }
+    for (i = 0; i < b->mesh.num_vertices; i++) {
+        const float *p = b->vertices[i].position;
+        float d = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        if (d > radius) {
+            radius = d;
+        }
+    }
+    b->mesh.radius = radius;
+}
+
+static void parse_texture(char **tok, int n) {
+    struct texture_build *t;
+    int w, h, k;
+
+    if (n < 5) {
+        die("texture needs a name, a kind and a size");
+    }
+    w = atoi(tok[3]);
+    h = atoi(tok[4]);
+    if (w <= 0 || h <= 0 || w > 4096 || h > 4096) {
+        die("bad texture size");
+    }
+
+    texture_names = grow(texture_names, num_textures, sizeof(*texture_names));
+    textures = grow(textures, num_textures, sizeof(*textures));
+    set_name(&texture_names[num_textures], tok[1]);
+    t = &textures[num_textures++];
+    memset(t, 0, sizeof(*t));
+    t->texture.width = w;
+    t->texture.height = h;
+    t->texture.filter = SCN_NEAREST;
+    t->texels = malloc((size_t) w * h * 4);
+    if (!t->texels) {
+        die("out of memory");
+    }
+
+    k = 5;
+    if (strcmp(tok[2], "checker") == 0) {
+        Checker(t->texels, w, h);
+    } else if (strcmp(tok[2], "raw") == 0) {
+        FILE *f;
+        if (n < 6) {
+            die("raw texture needs a file");
+        }
+        f = fopen(tok[5], "rb");
+        if (!f || fread(t->texels, 4, (size_t) w * h, f) != (size_t) w * h) {
+            die("can't read texture file");
+        }
+        fclose(f);
+        k = 6;
+    } else {
+        die("unknown texture kind");
+    }
+    for (; k < n; k++) {
+        if (strcmp(tok[k], "linear") == 0) {
+            t->texture.filter = SCN_LINEAR;
+        } else {
+            die("unknown texture option");
+        }
+    }
+}
+
+static void parse_material(char **tok, int n) {
+    struct scn_material *m;
+    int k;
+
+    if (n < 6) {
+        die("material needs a name and a color");
+    }
+    material_names = grow(material_names, num_materials, sizeof(*material_names));
+    materials = grow(materials, num_materials, sizeof(*materials));
+    set_name(&material_names[num_materials], tok[1]);
+    m = &materials[num_materials++];
+    memset(m, 0, sizeof(*m));
+    for (k = 0; k < 4; k++) {
+        m->color[k] = atof(tok[2 + k]);
+    }
+    m->line_width = 1.0;
+
+    for (k = 6; k < n; k++) {
+        if (strcmp(tok[k], "lit") == 0) {
+            m->flags |= SCN_LIT;
+        } else if (strcmp(tok[k], "wireframe") == 0) {
+            m->flags |= SCN_WIREFRAME;
+        } else if (strcmp(tok[k], "blend") == 0) {
+            m->flags |= SCN_BLEND;
+        } else if (strcmp(tok[k], "cull") == 0) {
+            m->flags |= SCN_CULL;
+        } else if (strcmp(tok[k], "line") == 0 && k + 1 < n) {
+            m->line_width = atof(tok[++k]);
+        } else {
+            die("unknown material option");
+        }
+    }
+}
+
+/* tessellation count, the builders divide by it */
+static int count(const char *tok) {
+    int n = atoi(tok);
+
+    if (n <= 0) {
+        die("tessellation counts must be positive");
+    }
+    return n;
+}
+
+/* returns 1 when the mesh continues with inline v/i lines */
+static int parse_mesh(char **tok, int n) {
+    struct mesh_build *b;
+
+    if (n < 3) {
+        die("mesh needs a name and a kind");
+    }
+    mesh_names = grow(mesh_names, num_meshes, sizeof(*mesh_names));
+    meshes = grow(meshes, num_meshes, sizeof(*meshes));
+    set_name(&mesh_names[num_meshes], tok[1]);
+    b = &meshes[num_meshes++];
+    memset(b, 0, sizeof(*b));
+    b->mesh.mode = SCN_QUADS;
+
+    /* the procedural meshes go through the same code as the samples */
+    rec_reset();
+    if (strcmp(tok[2], "torus") == 0 && n == 7) {
+        Torus(atof(tok[3]), atof(tok[4]), count(tok[5]), count(tok[6]));
+    } else if (strcmp(tok[2], "cone") == 0 && n == 7) {
+        cylinder(atof(tok[3]), 0.0, atof(tok[4]), count(tok[5]), count(tok[6]));
+    } else if (strcmp(tok[2], "sphere") == 0 && n == 6) {
+        sphere(atof(tok[3]), count(tok[4]), count(tok[5]));
+    } else if (strcmp(tok[2], "cube") == 0 && n == 4) {
+        Cube(atof(tok[3]));
+    } else if (strcmp(tok[2], "quads") == 0 && n == 3) {
+        return 1;
+    } else if (strcmp(tok[2], "triangles") == 0 && n == 3) {
+        b->mesh.mode = SCN_TRIANGLES;
+        return 1;
+    } else {
+        die("bad mesh");
+    }
+    build_recorded(b);
+    finish_mesh(b);
+    return 0;
+}
+
+static void parse_mesh_data(char **tok, int n) {
+    struct mesh_build *b = &meshes[num_meshes - 1];
+    int k;
+
+    if (strcmp(tok[0], "v") == 0 && n == 9) {
+        add_vertex(b, atof(tok[1]), atof(tok[2]), atof(tok[3]),
+                   atof(tok[4]), atof(tok[5]), atof(tok[6]),
+                   atof(tok[7]), atof(tok[8]));
+    } else if (strcmp(tok[0], "i") == 0) {
+        for (k = 1; k < n; k++) {
+            add_index(b, atol(tok[k]));
+        }
+    } else {
+        die("expected v, i or end");
+    }
+}
+
+static void parse_object(char **tok, int n) {
+    struct scn_object *o;
+    int k;
+
+    if (n != 7 && n != 11) {
+        die("object needs a mesh, a material, a texture and a position");
+    }
+    objects = grow(objects, num_objects, sizeof(*objects));
+    o = &objects[num_objects++];
+    memset(o, 0, sizeof(*o));
+    o->mesh = find(mesh_names, num_meshes, tok[1]);
+    o->material = find(material_names, num_materials, tok[2]);
+    o->texture = strcmp(tok[3], "-") == 0
+                 ? SCN_NO_TEXTURE : find(texture_names, num_textures, tok[3]);
+    for (k = 0; k < 3; k++) {
+        o->translate[k] = atof(tok[4 + k]);
+    }
+    if (n == 11) {
+        for (k = 0; k < 4; k++) {
+            o->rotate[k] = atof(tok[7 + k]);
+        }
+    } else {
+        o->rotate[3] = 1.0;
+    }
+}
+
+static void parse(FILE *f) {
+    char line[MAX_LINE];
+    char *tok[64];
+    int in_mesh = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        char *p;
+        int n = 0;
+
+        line_no++;
+        if ((p = strchr(line, '#')) != NULL) {
+            *p = '\0';
+        }
+        for (p = strtok(line, " \t\r\n"); p && n < 64; p = strtok(NULL, " \t\r\n")) {
+            tok[n++] = p;
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        if (in_mesh) {
+            if (strcmp(tok[0], "end") == 0) {
+                finish_mesh(&meshes[num_meshes - 1]);
+                in_mesh = 0;
+            } else {
+                parse_mesh_data(tok, n);
+            }
+        } else if (strcmp(tok[0], "texture") == 0) {
+            parse_texture(tok, n);
+        } else if (strcmp(tok[0], "material") == 0) {
+            parse_material(tok, n);
+        } else if (strcmp(tok[0], "mesh") == 0) {
+            in_mesh = parse_mesh(tok, n);
+        } else if (strcmp(tok[0], "object") == 0) {
+            parse_object(tok, n);
+        } else {
+            die("unknown statement");
+        }
+    }
+    if (in_mesh) {
+        die("missing end");
+    }
+}
+
+static void replicate(int copies) {
+    uint32_t base = num_objects, i;
+    int side = (int) ceil(sqrt(copies)), c;
+
+    for (c = 1; c < copies; c++) {
+        for (i = 0; i < base; i++) {
+            struct scn_object *o;
+            objects = grow(objects, num_objects, sizeof(*objects));
+            o = &objects[num_objects++];
+            *o = objects[i];
+            o->translate[0] += 12.0 * (c % side);
+            o->translate[2] -= 12.0 * (c / side);
+        }
+    }
+}
+
+static uint32_t put(struct buffer *out, const void *data, size_t size) {
+    uint32_t offset = out->size;
+    size_t padded = (size + 3) & ~(size_t) 3;
+
+    if (out->size + padded > out->alloc) {
+        while (out->size + padded > out->alloc) {
+            out->alloc = out->alloc ? out->alloc * 2 : 4096;
+        }
+        out->data = realloc(out->data, out->alloc);
+        if (!out->data) {
+            die("out of memory");
+        }
+    }
+    if (data) {
+        memcpy(out->data + out->size, data, size);
+    } else {
+        memset(out->data + out->size, 0, size);
+    }
+    memset(out->data + out->size + size, 0, padded - size);
+    out->size += padded;
+    return offset;
+}
+
+static void write_scene(const char *path) {
+    struct buffer out = {NULL, 0, 0};
+    struct scn_header h;
+    uint32_t i;
+    FILE *f;
+
+    memset(&h, 0, sizeof(h));
+    put(&out, NULL, sizeof(h));
+
+    /* tables first, their data offsets are filled in below */
+    h.num_meshes = num_meshes;
+    h.meshes = put(&out, NULL, num_meshes * sizeof(struct scn_mesh));
+    h.num_materials = num_materials;
+    h.materials = put(&out, materials, num_materials * sizeof(struct scn_material));
+    h.num_textures = num_textures;
+    h.textures = put(&out, NULL, num_textures * sizeof(struct scn_texture));
+    h.num_objects = num_objects;
+    h.objects = put(&out, objects, num_objects * sizeof(struct scn_object));
+
+    for (i = 0; i < num_meshes; i++) {
+        struct mesh_build *b = &meshes[i];
+        b->mesh.vertices = put(&out, b->vertices, b->mesh.num_vertices * sizeof(struct scn_vertex));
+        b->mesh.indices = put(&out, b->indices, b->mesh.num_indices * sizeof(uint16_t));
+        memcpy(out.data + h.meshes + i * sizeof(struct scn_mesh), &b->mesh, sizeof(b->mesh));
+    }
+    for (i = 0; i < num_textures; i++) {
+        struct texture_build *t = &textures[i];
+        t->texture.texels = put(&out, t->texels, (size_t) t->texture.width * t->texture.height * 4);
+        memcpy(out.data + h.textures + i * sizeof(struct scn_texture), &t->texture, sizeof(t->texture));
+    }
+
+    h.magic = SCN_MAGIC;
+    h.version = SCN_VERSION;
+    h.size = out.size;
+    memcpy(out.data, &h, sizeof(h));
+
+    f = fopen(path, "wb");
+    if (!f || fwrite(out.data, 1, out.size, f) != out.size || fclose(f) != 0) {
+        fprintf(stderr, "can't write %s\n", path);
+        exit(1);
+    }
+    free(out.data);
+
+    printf("%s: %u meshes, %u materials, %u textures, %u objects, %u bytes\n",
+           path, (unsigned) num_meshes, (unsigned) num_materials,
+           (unsigned) num_textures, (unsigned) num_objects, (unsigned) h.size);
+}
+
+int main(int argc, char *argv[]) {
+    int copies = 1, arg = 1;
+    FILE *f;
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        copies = atoi(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg != 2 || copies < 1) {
+        fprintf(stderr, "usage: %s [-r copies] input.txt output.scn\n", argv[0]);
+        return 1;
+    }
+
+    input_name = argv[arg];
+    f = fopen(input_name, "r");
+    if (!f) {
+        fprintf(stderr, "can't open %s\n", input_name);
+        return 1;
+    }
+    parse(f);
+    fclose(f);
+
+    replicate(copies);
+    write_scene(argv[arg + 1]);
+
+    return 0;
+}
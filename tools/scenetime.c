@@ -0,0 +1,143 @@
+/**
+ * scenetime - compare loading a binary scene with tessellating it.
+ *
+ *   scenetime scene.scn
+ *
+ * Build a large scene with scenec -r, e.g.
+ *
+ *   scenec -r 4000 ostest1.txt big.scn && scenetime big.scn
+ *
+ * Each path runs in its own process, so the peak RSS it reports is its own:
+ *
+ *   mapped      scene_load() and the per object setup of ostest1's
+ *               load_scene(), the way ostest1 starts from a scene file
+ *   procedural  tessellates one ostest1 built-in mesh per object of the
+ *               file (torus, cone, sphere, cube in turn, with the sample
+ *               parameters) and keeps the vertices, the way a scene built
+ *               in code would
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "recorder.h"
+#include "scene.h"
+#include "shapes.h"
+
+static double now_ms(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/* both paths return 0 on success, run() reads their rusage */
+static int mapped(const char *path, uint32_t count) {
+    struct scene scene;
+    double t0 = now_ms();
+    uint32_t i;
+    volatile float radius = 0.0;     /* keeps the reads */
+
+    if (!scene_load(&scene, path)) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        const struct scn_object *o = &scene.objects[i];
+        radius += scene.meshes[o->mesh].radius + scene.materials[o->material].color[3];
+    }
+    printf("mapped:     %u objects in %.3f ms\n", (unsigned) count, now_ms() - t0);
+    scene_free(&scene);
+
+    return 0;
+}
+
+static int procedural(const char *path, uint32_t count) {
+    double t0 = now_ms();
+    GLfloat **kept;
+    unsigned long vertices = 0;
+    uint32_t i;
+
+    kept = malloc(count * sizeof(*kept));
+    if (!kept) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        rec_reset();
+        switch (i % 4) {
+            case 0:
+                Torus(0.275, 0.85, 20, 20);
+                break;
+            case 1:
+                cylinder(1.0, 0.0, 2.0, 16, 1);
+                break;
+            case 2:
+                sphere(1.2, 20, 20);
+                break;
+            default:
+                Cube(1.0);
+                break;
+        }
+        kept[i] = malloc(rec.num_vertices * 6 * sizeof(GLfloat));
+        if (!kept[i]) {
+            return 1;
+        }
+        memcpy(kept[i], rec.vertices, rec.num_vertices * 6 * sizeof(GLfloat));
+        vertices += rec.num_vertices;
+    }
+    printf("procedural: %u objects in %.3f ms (%lu vertices)\n",
+           (unsigned) count, now_ms() - t0, vertices);
+
+    return 0;
+}
+
+static int run(const char *name, int (*fn)(const char *, uint32_t),
+               const char *path, uint32_t count) {
+    struct rusage ru;
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 0;
+    }
+    if (pid == 0) {
+        exit(fn(path, count));
+    }
+    if (wait4(pid, &status, 0, &ru) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s run failed\n", name);
+        return 0;
+    }
+    printf("            peak RSS %ld KiB\n", ru.ru_maxrss);
+
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    struct scene scene;
+    uint32_t count;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s scene.scn\n", argv[0]);
+        return 1;
+    }
+
+    /* the object count, the file is loaded again in the child */
+    if (!scene_load(&scene, argv[1])) {
+        return 1;
+    }
+    count = scene.header->num_objects;
+    scene_free(&scene);
+
+    if (!run("mapped", mapped, argv[1], count)
+        || !run("procedural", procedural, argv[1], count)) {
+        return 1;
+    }
+
+    return 0;
+}